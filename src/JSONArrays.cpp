@@ -0,0 +1,252 @@
+// JSONArrays.cpp
+// The parallel loader of top-level arrays.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+#include "JSONScanner.h"
+#include "JSONReader.h"
+#include "JSONPool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iterator>
+#include <list>
+
+//! @brief A piece of the elements of an array, parsed on its own.
+struct ArrayPiece
+{
+    //! @brief The offset of the '[' or ',' the piece starts after.
+    std::size_t begin = 0;
+
+    //! @brief The offset the piece stops at, see JSON::Reader::readElements().
+    std::size_t stop = std::string_view::npos;
+
+    //! @brief The offset of the ',' or ']' the piece ended on, once parsed.
+    std::size_t end = 0;
+
+    //! @brief The elements parsed from the piece.
+    JSON::Array elements;
+
+    //! @brief True if the piece was parsed. A piece starting at a wrong guess may not be.
+    bool parsed = false;
+};
+
+//! @brief Returns true if c ends an element starting with opening.
+static bool closes(char c, char opening)
+{
+    switch (opening)
+    {
+        case '{': return c == '}';
+        case '[': return c == ']';
+        case '"': return c == '"';
+        default: return std::isalnum(static_cast < unsigned char >(c));
+    }
+}
+
+//! @brief Returns true if c starts an element like the one starting with opening.
+static bool opens(char c, char opening)
+{
+    switch (opening)
+    {
+        case '{': case '[': case '"': return c == opening;
+        default: return c == '-' || std::isalnum(static_cast < unsigned char >(c));
+    }
+}
+
+std::size_t JSON::Reader::guessSplit(std::string_view content, std::size_t offset, std::size_t limit, char opening)
+{
+    const char* begin = content.data(), *end = begin + content.size();
+    const char* stop = begin + std::min(limit, offset + JSON_ARRAY_PIECE / 16);
+    const char* it = static_cast < const char* >(std::memchr(begin + offset, '\n', stop - (begin + offset)));
+
+    if (it)
+        it = it + 1;
+
+    // Without a newline, the search starts after the ':' of a key, an unescaped '"' followed by ':',
+    // or at the offset if there is no key.
+    else
+    {
+        for (it = Scanner::findStructural(begin + offset, stop); it < stop; it = Scanner::findStructural(it + 1, stop))
+        {
+            if (*it == ':' && it[-1] == '"' && it[-2] != '\\')
+                break;
+        }
+
+        it = it < stop ? it + 1 : begin + offset;
+    }
+
+    // The elements of the array are the shallowest values met: the ',' kept is the first one
+    // at the lowest depth.
+    long depth = 0, lowest = 0;
+    const char* candidate = nullptr;
+
+    for (it = Scanner::findStructural(it, stop); it < stop; it = Scanner::findStructural(it + 1, stop))
+    {
+        switch (*it)
+        {
+            case '"':
+            {
+                it = Scanner::findQuoteOrEscape(it + 1, end);
+
+                while (it < end && *it == '\\')
+                    it = Scanner::findQuoteOrEscape(it + 2 < end ? it + 2 : end, end);
+
+                break;
+            }
+
+            case '{':
+            case '[':
+                depth = depth + 1;
+                break;
+
+            case '}':
+            case ']':
+            {
+                depth = depth - 1;
+
+                if (depth < lowest)
+                {
+                    lowest = depth;
+                    candidate = nullptr;
+                }
+
+                break;
+            }
+
+            case ',':
+            {
+                if (candidate || depth != lowest)
+                    break;
+
+                const char* previous = it - 1;
+
+                while (previous > begin && std::isspace(static_cast < unsigned char >(*previous)))
+                    previous = previous - 1;
+
+                Scanner::Lines lines;
+                const char* next = Scanner::skipWhitespace(it + 1, end, lines);
+
+                if (next < end && closes(*previous, opening) && opens(*next, opening))
+                    candidate = it;
+
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    return candidate ? candidate - begin : std::string_view::npos;
+}
+
+void JSON::Reader::readElementsInParallel(JSON::Array& array, unsigned threads)
+{
+    if (!threads)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    const char* data = mContent.data();
+    std::size_t first = mPos, size = mContent.size() - first;
+    std::size_t count = std::min < std::size_t >(size / JSON_ARRAY_PIECE, 4 * threads);
+
+    Scanner::Lines lines;
+    const char* opening = Scanner::skipWhitespace(data + first + 1, data + mContent.size(), lines);
+
+    // The first piece starts at the '[', the others at guessed commas.
+    std::list < ArrayPiece > guesses(1);
+    guesses.back().begin = first;
+
+    for (std::size_t i = 1; i < count && opening < data + mContent.size(); ++i)
+    {
+        std::size_t offset = std::max(first + size * i / count, guesses.back().begin + 1);
+        std::size_t limit = first + size * (i + 1) / count;
+
+        std::size_t split = offset < limit ? guessSplit(mContent, offset, limit, *opening) : std::string_view::npos;
+
+        if (split != std::string_view::npos)
+        {
+            guesses.back().stop = split;
+            guesses.emplace_back();
+            guesses.back().begin = split;
+        }
+    }
+
+    if (guesses.size() == 1)
+    {
+        readElements(array, std::string_view::npos);
+        return;
+    }
+
+    std::vector < ArrayPiece* > pieces;
+
+    for (ArrayPiece& piece : guesses)
+        pieces.push_back(&piece);
+
+    WorkStealingPool(pieces.size(), static_cast < unsigned >(std::min < std::size_t >(threads, pieces.size())))
+    .run([this, &pieces](std::size_t index)
+    {
+        ArrayPiece& piece = *pieces[index];
+        Reader reader(mContent, nullptr, mStorage);
+        reader.mPos = piece.begin;
+
+        // A piece after a wrong guess may fail: its elements are parsed again, reporting the
+        // error if there is a real one.
+        try
+        {
+            reader.readElements(piece.elements, piece.stop);
+            piece.end = reader.mPos;
+            piece.parsed = true;
+        }
+
+        catch(...)
+        {
+
+        }
+    });
+
+    // Walks the elements from the '[': a piece is kept when the elements before it end on its
+    // start, which is then a real comma. Otherwise the elements up to the next guess are parsed
+    // again on this thread.
+    std::list < ArrayPiece > reparsed;
+    std::vector < JSON::Array* > segments;
+    std::size_t position = first, index = 0;
+
+    while (data[position] != ']')
+    {
+        while (index < pieces.size() && pieces[index]->begin < position)
+            index = index + 1;
+
+        if (index < pieces.size() && pieces[index]->begin == position)
+        {
+            index = index + 1;
+
+            if (pieces[index - 1]->parsed)
+            {
+                segments.push_back(&pieces[index - 1]->elements);
+                position = pieces[index - 1]->end;
+                continue;
+            }
+        }
+
+        seek(position);
+        reparsed.emplace_back();
+        readElements(reparsed.back().elements, index < pieces.size() ? pieces[index]->begin : std::string_view::npos);
+
+        segments.push_back(&reparsed.back().elements);
+        position = mPos;
+    }
+
+    seek(position);
+
+    // Elements have no names, their index is their position: segments are joined as they are.
+    std::size_t elements = 0;
+
+    for (JSON::Array* segment : segments)
+        elements = elements + segment->size();
+
+    array.reserve(elements);
+
+    for (JSON::Array* segment : segments)
+        std::move(segment->begin(), segment->end(), std::back_inserter(array));
+}
@@ -0,0 +1,1074 @@
+// JSONBinary.cpp
+// The writer and readers of CBOR and MessagePack.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+//! @brief Returns the integer of size bytes stored at data in big-endian order.
+static std::uint64_t bigEndian(const char* data, std::size_t size)
+{
+    std::uint64_t value = 0;
+
+    for (std::size_t i = 0; i < size; ++i)
+        value = (value << 8) | static_cast < unsigned char >(data[i]);
+
+    return value;
+}
+
+//! @brief Returns true if the number is a float, or a double held exactly by a float.
+static bool isFloat(double number)
+{
+    return !std::isfinite(number) || (std::fabs(number) <= FLT_MAX && static_cast < float >(number) == number);
+}
+
+JSON::BinaryWriter::BinaryWriter(BinaryFormat format)
+: mOutput(Writer::L_COMPACT)
+, mFormat(format)
+{
+
+}
+
+JSON::BinaryWriter::BinaryWriter(std::ostream& stream, BinaryFormat format)
+: mOutput(stream, Writer::L_COMPACT)
+, mFormat(format)
+{
+
+}
+
+JSON::BinaryWriter::BinaryWriter(int fd, BinaryFormat format)
+: mOutput(fd, Writer::L_COMPACT)
+, mFormat(format)
+{
+
+}
+
+void JSON::BinaryWriter::writeBigEndian(std::uint64_t value, unsigned size)
+{
+    char buffer[8];
+
+    for (unsigned i = 0; i < size; ++i)
+        buffer[i] = static_cast < char >(value >> (8 * (size - 1 - i)));
+
+    mOutput.mBuffer.append(buffer, size);
+}
+
+void JSON::BinaryWriter::writeHead(std::uint8_t major, std::uint64_t argument)
+{
+    std::string& buffer = mOutput.mBuffer;
+    major = static_cast < std::uint8_t >(major << 5);
+
+    // Arguments below 24 are held by the initial byte, larger ones follow it on 1 to 8 bytes.
+    if (argument < 24)
+        buffer.push_back(static_cast < char >(major | argument));
+
+    else if (argument <= 0xFF)
+    {
+        buffer.push_back(static_cast < char >(major | 24));
+        writeBigEndian(argument, 1);
+    }
+
+    else if (argument <= 0xFFFF)
+    {
+        buffer.push_back(static_cast < char >(major | 25));
+        writeBigEndian(argument, 2);
+    }
+
+    else if (argument <= 0xFFFFFFFF)
+    {
+        buffer.push_back(static_cast < char >(major | 26));
+        writeBigEndian(argument, 4);
+    }
+
+    else
+    {
+        buffer.push_back(static_cast < char >(major | 27));
+        writeBigEndian(argument, 8);
+    }
+}
+
+void JSON::BinaryWriter::writeSize(std::uint8_t fixed, std::size_t limit, int code8, std::uint8_t code16, std::size_t size)
+{
+    std::string& buffer = mOutput.mBuffer;
+
+    if (size < limit)
+        buffer.push_back(static_cast < char >(fixed | size));
+
+    else if (code8 >= 0 && size <= 0xFF)
+    {
+        buffer.push_back(static_cast < char >(code8));
+        writeBigEndian(size, 1);
+    }
+
+    else if (size <= 0xFFFF)
+    {
+        buffer.push_back(static_cast < char >(code16));
+        writeBigEndian(size, 2);
+    }
+
+    else
+    {
+        JSON_THROW_IF(size > 0xFFFFFFFF, Exception("MessagePack: %zu entries do not fit in 32 bits.", size));
+
+        // The 32 bits form follows the 16 bits one.
+        buffer.push_back(static_cast < char >(code16 + 1));
+        writeBigEndian(size, 4);
+    }
+}
+
+void JSON::BinaryWriter::writeInteger(std::int64_t number)
+{
+    if (number >= 0)
+        writeUnsigned(static_cast < std::uint64_t >(number));
+
+    // CBOR stores -1 - n, which is ~n in two's complement.
+    else if (mFormat == B_CBOR)
+        writeHead(1, ~static_cast < std::uint64_t >(number));
+
+    else if (number >= -32)
+        mOutput.mBuffer.push_back(static_cast < char >(number));
+
+    else if (number >= INT8_MIN)
+    {
+        mOutput.mBuffer.push_back('\xD0');
+        writeBigEndian(static_cast < std::uint64_t >(number), 1);
+    }
+
+    else if (number >= INT16_MIN)
+    {
+        mOutput.mBuffer.push_back('\xD1');
+        writeBigEndian(static_cast < std::uint64_t >(number), 2);
+    }
+
+    else if (number >= INT32_MIN)
+    {
+        mOutput.mBuffer.push_back('\xD2');
+        writeBigEndian(static_cast < std::uint64_t >(number), 4);
+    }
+
+    else
+    {
+        mOutput.mBuffer.push_back('\xD3');
+        writeBigEndian(static_cast < std::uint64_t >(number), 8);
+    }
+}
+
+void JSON::BinaryWriter::writeUnsigned(std::uint64_t number)
+{
+    if (mFormat == B_CBOR)
+        writeHead(0, number);
+
+    else if (number < 0x80)
+        mOutput.mBuffer.push_back(static_cast < char >(number));
+
+    else if (number <= 0xFF)
+    {
+        mOutput.mBuffer.push_back('\xCC');
+        writeBigEndian(number, 1);
+    }
+
+    else if (number <= 0xFFFF)
+    {
+        mOutput.mBuffer.push_back('\xCD');
+        writeBigEndian(number, 2);
+    }
+
+    else if (number <= 0xFFFFFFFF)
+    {
+        mOutput.mBuffer.push_back('\xCE');
+        writeBigEndian(number, 4);
+    }
+
+    else
+    {
+        mOutput.mBuffer.push_back('\xCF');
+        writeBigEndian(number, 8);
+    }
+}
+
+void JSON::BinaryWriter::writeNumber(double number)
+{
+    bool single = isFloat(number);
+
+    if (mFormat == B_CBOR)
+        mOutput.mBuffer.push_back(single ? '\xFA' : '\xFB');
+
+    else
+        mOutput.mBuffer.push_back(single ? '\xCA' : '\xCB');
+
+    if (single)
+    {
+        float value = static_cast < float >(number);
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeBigEndian(bits, 4);
+    }
+
+    else
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &number, sizeof(bits));
+        writeBigEndian(bits, 8);
+    }
+}
+
+void JSON::BinaryWriter::writeString(std::string_view string)
+{
+    if (mFormat == B_CBOR)
+        writeHead(3, string.size());
+
+    else
+        writeSize(0xA0, 32, 0xD9, 0xDA, string.size());
+
+    mOutput.mBuffer.append(string);
+}
+
+void JSON::BinaryWriter::writePayload(const Value& value)
+{
+    switch (value.mType)
+    {
+        case Value::T_OBJECT:
+            writeObject(*value.mObject);
+            break;
+
+        case Value::T_ARRAY:
+            writeArray(*value.mArray);
+            break;
+
+        case Value::T_STRING:
+            writeString(value.toStringView());
+            break;
+
+        case Value::T_NUMBER:
+            if (value.mFlags & Value::F_INTEGER)
+                writeInteger(value.mInteger);
+
+            else if (value.mFlags & Value::F_UNSIGNED)
+                writeUnsigned(value.mUnsigned);
+
+            else
+                writeNumber(value.mNumber);
+
+            break;
+
+        case Value::T_BOOLEAN:
+            if (mFormat == B_CBOR)
+                mOutput.mBuffer.push_back(value.mBoolean ? '\xF5' : '\xF4');
+
+            else
+                mOutput.mBuffer.push_back(value.mBoolean ? '\xC3' : '\xC2');
+
+            break;
+
+        case Value::T_NULL:
+            mOutput.mBuffer.push_back(mFormat == B_CBOR ? '\xF6' : '\xC0');
+            break;
+    }
+
+    mOutput.spill();
+}
+
+void JSON::BinaryWriter::writeObject(const JSON& object)
+{
+    if (mFormat == B_CBOR)
+        writeHead(5, object.values().size());
+
+    else
+        writeSize(0x80, 16, -1, 0xDE, object.values().size());
+
+    for (const Value& value : object.values())
+    {
+        writeString(value.name());
+        writePayload(value);
+    }
+}
+
+void JSON::BinaryWriter::writeArray(const Array& array)
+{
+    if (mFormat == B_CBOR)
+        writeHead(4, array.size());
+
+    else
+        writeSize(0x90, 16, -1, 0xDC, array.size());
+
+    for (const Value& value : array)
+        writePayload(value);
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(const JSON& object)
+{
+    writeObject(object);
+    mOutput.spill();
+    return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(const Value& value)
+{
+    writePayload(value);
+    return *this;
+}
+
+std::string_view JSON::BinaryWriter::content() const
+{
+    return mOutput.content();
+}
+
+void JSON::BinaryWriter::clear()
+{
+    mOutput.clear();
+}
+
+void JSON::BinaryWriter::flush()
+{
+    mOutput.flush();
+}
+
+std::string JSON::toCBOR() const
+{
+    BinaryWriter writer(B_CBOR);
+    writer.write(*this);
+    return std::move(writer.mOutput.mBuffer);
+}
+
+std::string JSON::toMessagePack() const
+{
+    BinaryWriter writer(B_MESSAGEPACK);
+    writer.write(*this);
+    return std::move(writer.mOutput.mBuffer);
+}
+
+//! @brief The length of a map, an array or a string that ends with a break.
+static const std::size_t Indefinite = std::string_view::npos;
+
+struct JSON::BinaryReader::Item
+{
+    enum Kind { K_OBJECT, K_ARRAY, K_STRING, K_INTEGER, K_UNSIGNED, K_NUMBER, K_BOOLEAN, K_NULL, K_BREAK };
+
+    //! @brief The kind of the item.
+    Kind kind = K_NULL;
+
+    //! @brief The number of members or elements of a map or an array, or Indefinite.
+    std::size_t length = 0;
+
+    //! @brief The payload, depending on the kind.
+    std::int64_t integer = 0;
+    std::uint64_t unsignedInteger = 0;
+    double number = 0;
+    bool boolean = false;
+
+    //! @brief The string, a view into the data or into mScratch until the next item.
+    std::string_view string;
+};
+
+JSON::BinaryReader::BinaryReader(std::string_view data, BinaryFormat format)
+: mData(data)
+, mPos(0)
+, mFormat(format)
+{
+
+}
+
+const char* JSON::BinaryReader::formatName() const
+{
+    return mFormat == B_CBOR ? "CBOR" : "MessagePack";
+}
+
+void JSON::BinaryReader::need(std::size_t size) const
+{
+    JSON_THROW_IF(mData.size() - mPos < size, Exception("%s(%zu): unexpected end of data.", formatName(), mPos));
+}
+
+std::uint64_t JSON::BinaryReader::readBigEndian(std::size_t size)
+{
+    need(size);
+    std::uint64_t value = bigEndian(mData.data() + mPos, size);
+    mPos = mPos + size;
+    return value;
+}
+
+JSON::BinaryReader::Item JSON::BinaryReader::next()
+{
+    return mFormat == B_CBOR ? nextCBOR() : nextMessagePack();
+}
+
+//! @brief Returns the CBOR half float as a double.
+static double halfToDouble(std::uint16_t half)
+{
+    int exponent = (half >> 10) & 0x1F, mantissa = half & 0x3FF;
+    double value = 0;
+
+    if (exponent == 0)
+        value = std::ldexp(mantissa, -24);
+
+    else if (exponent != 31)
+        value = std::ldexp(mantissa + 1024, exponent - 25);
+
+    else
+        value = mantissa ? NAN : INFINITY;
+
+    return half & 0x8000 ? -value : value;
+}
+
+JSON::BinaryReader::Item JSON::BinaryReader::nextCBOR()
+{
+    need(1);
+    std::size_t offset = mPos;
+    unsigned initial = static_cast < unsigned char >(mData[mPos++]);
+    unsigned major = initial >> 5, info = initial & 0x1F;
+    Item item;
+
+    if (major == 7)
+    {
+        switch (info)
+        {
+            case 20: case 21:
+                item.kind = Item::K_BOOLEAN;
+                item.boolean = info == 21;
+                return item;
+
+            case 22: case 23:
+                item.kind = Item::K_NULL;
+                return item;
+
+            case 25:
+                item.kind = Item::K_NUMBER;
+                item.number = halfToDouble(static_cast < std::uint16_t >(readBigEndian(2)));
+                return item;
+
+            case 26:
+            {
+                std::uint32_t bits = static_cast < std::uint32_t >(readBigEndian(4));
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+
+                item.kind = Item::K_NUMBER;
+                item.number = value;
+                return item;
+            }
+
+            case 27:
+            {
+                std::uint64_t bits = readBigEndian(8);
+                item.kind = Item::K_NUMBER;
+                std::memcpy(&item.number, &bits, sizeof(bits));
+                return item;
+            }
+
+            case 31:
+                item.kind = Item::K_BREAK;
+                return item;
+
+            default:
+                throw Exception("CBOR(%zu): unsupported simple value %u.", offset, info);
+        }
+    }
+
+    std::uint64_t argument = info;
+    bool indefinite = info == 31;
+
+    if (info >= 24 && info <= 27)
+        argument = readBigEndian(std::size_t(1) << (info - 24));
+
+    else
+        JSON_THROW_IF(info > 27 && (!indefinite || major < 2 || major > 5),
+        Exception("CBOR(%zu): invalid initial byte 0x%02x.", offset, initial));
+
+    switch (major)
+    {
+        case 0:
+        {
+            if (argument <= INT64_MAX)
+            {
+                item.kind = Item::K_INTEGER;
+                item.integer = static_cast < std::int64_t >(argument);
+            }
+
+            else
+            {
+                item.kind = Item::K_UNSIGNED;
+                item.unsignedInteger = argument;
+            }
+
+            return item;
+        }
+
+        case 1:
+        {
+            // Integers below the range of std::int64_t lose their exactness, like in texts.
+            if (argument <= INT64_MAX)
+            {
+                item.kind = Item::K_INTEGER;
+                item.integer = -1 - static_cast < std::int64_t >(argument);
+            }
+
+            else
+            {
+                item.kind = Item::K_NUMBER;
+                item.number = -1.0 - static_cast < double >(argument);
+            }
+
+            return item;
+        }
+
+        case 2:
+        case 3:
+        {
+            item.kind = Item::K_STRING;
+
+            if (!indefinite)
+            {
+                need(argument);
+                item.string = mData.substr(mPos, argument);
+                mPos = mPos + argument;
+                return item;
+            }
+
+            // The chunks are definite strings of the same type, up to a break.
+            mScratch.clear();
+
+            for (need(1); mData[mPos] != '\xFF'; need(1))
+            {
+                std::size_t chunk = mPos;
+                unsigned byte = static_cast < unsigned char >(mData[mPos]);
+
+                JSON_THROW_IF(byte >> 5 != major || (byte & 0x1F) == 31,
+                Exception("CBOR(%zu): invalid chunk in a string of indefinite length.", chunk));
+
+                mScratch.append(nextCBOR().string);
+            }
+
+            mPos = mPos + 1;
+            item.string = mScratch;
+            return item;
+        }
+
+        case 4:
+        case 5:
+        {
+            // Every entry takes a byte at least: longer lengths cannot be true.
+            JSON_THROW_IF(!indefinite && argument > mData.size() - mPos,
+            Exception("CBOR(%zu): length %llu exceeds the data.", offset, static_cast < unsigned long long >(argument)));
+
+            item.kind = major == 4 ? Item::K_ARRAY : Item::K_OBJECT;
+            item.length = indefinite ? Indefinite : static_cast < std::size_t >(argument);
+            return item;
+        }
+
+        default:
+            // Tags only tell how to interpret the item following them.
+            return nextCBOR();
+    }
+}
+
+JSON::BinaryReader::Item JSON::BinaryReader::nextMessagePack()
+{
+    need(1);
+    std::size_t offset = mPos;
+    unsigned code = static_cast < unsigned char >(mData[mPos++]);
+    Item item;
+
+    std::size_t string = Indefinite, length = Indefinite;
+
+    if (code <= 0x7F || code >= 0xE0)
+    {
+        item.kind = Item::K_INTEGER;
+        item.integer = static_cast < std::int8_t >(code);
+        return item;
+    }
+
+    else if (code <= 0x8F)
+    {
+        item.kind = Item::K_OBJECT;
+        length = code & 0x0F;
+    }
+
+    else if (code <= 0x9F)
+    {
+        item.kind = Item::K_ARRAY;
+        length = code & 0x0F;
+    }
+
+    else if (code <= 0xBF)
+        string = code & 0x1F;
+
+    else switch (code)
+    {
+        case 0xC0:
+            item.kind = Item::K_NULL;
+            return item;
+
+        case 0xC2: case 0xC3:
+            item.kind = Item::K_BOOLEAN;
+            item.boolean = code == 0xC3;
+            return item;
+
+        // Binaries and strings: their length follows on 1, 2 or 4 bytes.
+        case 0xC4: case 0xD9: string = readBigEndian(1); break;
+        case 0xC5: case 0xDA: string = readBigEndian(2); break;
+        case 0xC6: case 0xDB: string = readBigEndian(4); break;
+
+        case 0xCA:
+        {
+            std::uint32_t bits = static_cast < std::uint32_t >(readBigEndian(4));
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+
+            item.kind = Item::K_NUMBER;
+            item.number = value;
+            return item;
+        }
+
+        case 0xCB:
+        {
+            std::uint64_t bits = readBigEndian(8);
+            item.kind = Item::K_NUMBER;
+            std::memcpy(&item.number, &bits, sizeof(bits));
+            return item;
+        }
+
+        case 0xCC: case 0xCD: case 0xCE: case 0xCF:
+        {
+            std::uint64_t number = readBigEndian(std::size_t(1) << (code - 0xCC));
+
+            if (number <= INT64_MAX)
+            {
+                item.kind = Item::K_INTEGER;
+                item.integer = static_cast < std::int64_t >(number);
+            }
+
+            else
+            {
+                item.kind = Item::K_UNSIGNED;
+                item.unsignedInteger = number;
+            }
+
+            return item;
+        }
+
+        case 0xD0: case 0xD1: case 0xD2: case 0xD3:
+        {
+            std::size_t size = std::size_t(1) << (code - 0xD0);
+            std::uint64_t number = readBigEndian(size);
+
+            // Extends the sign of the smaller forms.
+            if (size < 8 && (number >> (8 * size - 1)))
+                number = number | (~std::uint64_t(0) << (8 * size));
+
+            item.kind = Item::K_INTEGER;
+            item.integer = static_cast < std::int64_t >(number);
+            return item;
+        }
+
+        case 0xDC: item.kind = Item::K_ARRAY; length = readBigEndian(2); break;
+        case 0xDD: item.kind = Item::K_ARRAY; length = readBigEndian(4); break;
+        case 0xDE: item.kind = Item::K_OBJECT; length = readBigEndian(2); break;
+        case 0xDF: item.kind = Item::K_OBJECT; length = readBigEndian(4); break;
+
+        default:
+            throw Exception("MessagePack(%zu): unsupported type 0x%02x.", offset, code);
+    }
+
+    if (string != Indefinite)
+    {
+        need(string);
+        item.kind = Item::K_STRING;
+        item.string = mData.substr(mPos, string);
+        mPos = mPos + string;
+        return item;
+    }
+
+    JSON_THROW_IF(length > mData.size() - mPos,
+    Exception("MessagePack(%zu): length %zu exceeds the data.", offset, length));
+
+    item.length = length;
+    return item;
+}
+
+bool JSON::BinaryReader::more(const Item& container, std::size_t index)
+{
+    if (container.length != Indefinite)
+        return index < container.length;
+
+    need(1);
+
+    if (mData[mPos] != '\xFF')
+        return true;
+
+    mPos = mPos + 1;
+    return false;
+}
+
+std::string_view JSON::BinaryReader::readKey()
+{
+    std::size_t offset = mPos;
+    Item key = next();
+
+    JSON_THROW_IF(key.kind != Item::K_STRING, Exception("%s(%zu): keys must be strings.", formatName(), offset));
+    JSON_THROW_IF(key.string.empty(), Exception("%s(%zu): key cannot be empty.", formatName(), offset));
+    return key.string;
+}
+
+JSON::Value JSON::BinaryReader::readValue(std::string_view name, const Item& item)
+{
+    switch (item.kind)
+    {
+        case Item::K_OBJECT:
+            return Value(name, readObject(item));
+
+        case Item::K_ARRAY:
+            return Value(name, readArray(item));
+
+        case Item::K_STRING:
+            return Value(name, std::string(item.string));
+
+        case Item::K_INTEGER:
+            return Value(name, item.integer);
+
+        case Item::K_UNSIGNED:
+            return Value(name, item.unsignedInteger);
+
+        case Item::K_NUMBER:
+            return Value(name, Number(item.number));
+
+        case Item::K_BOOLEAN:
+            return Value(name, item.boolean);
+
+        case Item::K_NULL:
+            return Value(name);
+
+        default:
+            throw Exception("%s(%zu): unexpected break.", formatName(), mPos - 1);
+    }
+}
+
+JSON JSON::BinaryReader::readObject(const Item& item)
+{
+    JSON object;
+
+    for (std::size_t i = 0; more(item, i); ++i)
+    {
+        // The key may be in mScratch, which the value reuses.
+        std::string name(readKey());
+        object.addValue(readValue(name, next()));
+    }
+
+    return object;
+}
+
+JSON::Array JSON::BinaryReader::readArray(const Item& item)
+{
+    Array array;
+
+    if (item.length != Indefinite)
+        array.reserve(item.length);
+
+    for (std::size_t i = 0; more(item, i); ++i)
+        array.push_back(readValue(std::string_view(), next()));
+
+    return array;
+}
+
+void JSON::BinaryReader::parseValue(const Item& item, Handler& handler)
+{
+    switch (item.kind)
+    {
+        case Item::K_OBJECT:
+        {
+            handler.startObject();
+
+            for (std::size_t i = 0; more(item, i); ++i)
+            {
+                handler.key(readKey());
+                parseValue(next(), handler);
+            }
+
+            handler.endObject();
+            break;
+        }
+
+        case Item::K_ARRAY:
+        {
+            handler.startArray();
+
+            for (std::size_t i = 0; more(item, i); ++i)
+                parseValue(next(), handler);
+
+            handler.endArray();
+            break;
+        }
+
+        case Item::K_STRING:
+            handler.string(item.string);
+            break;
+
+        case Item::K_INTEGER:
+            handler.integer(item.integer);
+            break;
+
+        case Item::K_UNSIGNED:
+            handler.unsignedInteger(item.unsignedInteger);
+            break;
+
+        case Item::K_NUMBER:
+            handler.number(item.number);
+            break;
+
+        case Item::K_BOOLEAN:
+            handler.boolean(item.boolean);
+            break;
+
+        case Item::K_NULL:
+            handler.null();
+            break;
+
+        default:
+            throw Exception("%s(%zu): unexpected break.", formatName(), mPos - 1);
+    }
+}
+
+bool JSON::BinaryReader::atEnd() const
+{
+    return mPos == mData.size();
+}
+
+std::size_t JSON::BinaryReader::position() const
+{
+    return mPos;
+}
+
+JSON JSON::BinaryReader::read()
+{
+    std::size_t offset = mPos;
+    Item item = next();
+
+    JSON_THROW_IF(item.kind != Item::K_OBJECT, Exception("%s(%zu): the document is not a map.", formatName(), offset));
+    return readObject(item);
+}
+
+void JSON::BinaryReader::read(Handler& handler)
+{
+    parseValue(next(), handler);
+}
+
+JSON JSON::fromCBOR(std::string_view data)
+{
+    BinaryReader reader(data, B_CBOR);
+    JSON document = reader.read();
+
+    JSON_THROW_IF(!reader.atEnd(), Exception("CBOR(%zu): unexpected data after the document.", reader.position()));
+    return document;
+}
+
+JSON JSON::fromMessagePack(std::string_view data)
+{
+    BinaryReader reader(data, B_MESSAGEPACK);
+    JSON document = reader.read();
+
+    JSON_THROW_IF(!reader.atEnd(), Exception("MessagePack(%zu): unexpected data after the document.", reader.position()));
+    return document;
+}
+
+//! @brief The head of an item, as scanned by BinaryPushParser.
+struct ItemHead
+{
+    //! @brief The size of the head and of the bytes of its string, if any.
+    std::uint64_t size = 0;
+
+    //! @brief The number of items it holds, or std::uint64_t(-1) if it ends with a break.
+    std::uint64_t items = 0;
+
+    //! @brief True if the head is a CBOR break.
+    bool isBreak = false;
+};
+
+//! @brief Scans the CBOR head at data. Returns false if it is incomplete.
+static bool scanCBOR(const unsigned char* data, std::size_t size, std::size_t offset, ItemHead& head)
+{
+    unsigned major = data[0] >> 5, info = data[0] & 0x1F;
+    std::uint64_t argument = info, extra = 0;
+
+    if (info == 31)
+    {
+        JSON_THROW_IF(major < 2 || major == 6, JSON::Exception("CBOR(%zu): invalid initial byte 0x%02x.", offset, data[0]));
+
+        head.size = 1;
+        head.isBreak = major == 7;
+        head.items = head.isBreak ? 0 : ~std::uint64_t(0);
+        return true;
+    }
+
+    JSON_THROW_IF(info > 27, JSON::Exception("CBOR(%zu): invalid initial byte 0x%02x.", offset, data[0]));
+
+    if (info >= 24)
+    {
+        extra = std::uint64_t(1) << (info - 24);
+
+        if (size < 1 + extra)
+            return false;
+
+        argument = bigEndian(reinterpret_cast < const char* >(data) + 1, extra);
+    }
+
+    head.size = 1 + extra;
+
+    switch (major)
+    {
+        case 2: case 3:
+            JSON_THROW_IF(argument > UINT64_MAX - head.size, JSON::Exception("CBOR(%zu): invalid length.", offset));
+            head.size = head.size + argument;
+            break;
+
+        case 4: head.items = argument; break;
+
+        case 5:
+            JSON_THROW_IF(argument > UINT64_MAX / 2 - 1, JSON::Exception("CBOR(%zu): invalid length.", offset));
+            head.items = 2 * argument;
+            break;
+
+        case 6: head.items = 1; break;
+
+        default: break;
+    }
+
+    return true;
+}
+
+//! @brief Scans the MessagePack head at data. Returns false if it is incomplete.
+static bool scanMessagePack(const unsigned char* data, std::size_t size, std::size_t offset, ItemHead& head)
+{
+    unsigned code = data[0];
+    std::uint64_t extra = 0, multiplier = 0;
+
+    head.size = 1;
+
+    if (code <= 0x7F || code >= 0xE0 || code == 0xC0 || code == 0xC2 || code == 0xC3)
+        return true;
+
+    else if (code <= 0x8F)
+        head.items = 2 * (code & 0x0F);
+
+    else if (code <= 0x9F)
+        head.items = code & 0x0F;
+
+    else if (code <= 0xBF)
+        head.size = 1 + (code & 0x1F);
+
+    else switch (code)
+    {
+        case 0xC4: case 0xD9: extra = 1; break;
+        case 0xC5: case 0xDA: extra = 2; break;
+        case 0xC6: case 0xDB: extra = 4; break;
+        case 0xCA: case 0xCE: case 0xD2: head.size = 5; break;
+        case 0xCB: case 0xCF: case 0xD3: head.size = 9; break;
+        case 0xCC: case 0xD0: head.size = 2; break;
+        case 0xCD: case 0xD1: head.size = 3; break;
+        case 0xDC: extra = 2; multiplier = 1; break;
+        case 0xDD: extra = 4; multiplier = 1; break;
+        case 0xDE: extra = 2; multiplier = 2; break;
+        case 0xDF: extra = 4; multiplier = 2; break;
+
+        default:
+            throw JSON::Exception("MessagePack(%zu): unsupported type 0x%02x.", offset, code);
+    }
+
+    if (extra)
+    {
+        if (size < 1 + extra)
+            return false;
+
+        std::uint64_t length = bigEndian(reinterpret_cast < const char* >(data) + 1, extra);
+        head.size = 1 + extra;
+
+        // Strings and binaries hold bytes, maps and arrays items.
+        if (multiplier)
+            head.items = multiplier * length;
+
+        else
+            head.size = head.size + length;
+    }
+
+    return true;
+}
+
+JSON::BinaryPushParser::BinaryPushParser(Handler& handler, BinaryFormat format)
+: mHandler(handler)
+, mFormat(format)
+, mStart(0)
+, mScanned(0)
+, mOffset(0)
+{
+
+}
+
+void JSON::BinaryPushParser::endItem()
+{
+    while (!mPending.empty())
+    {
+        std::uint64_t& pending = mPending.back();
+
+        if (pending == ~std::uint64_t(0) || --pending)
+            return;
+
+        mPending.pop_back();
+    }
+
+    // The document is complete: its events are sent from its bytes, dropped once the chunk is read.
+    BinaryReader reader(std::string_view(mBuffer.data() + mStart, mScanned - mStart), mFormat);
+    reader.read(mHandler);
+
+    mStart = mScanned;
+}
+
+void JSON::BinaryPushParser::feed(const char* data, std::size_t size)
+{
+    mBuffer.append(data, size);
+
+    while (mScanned < mBuffer.size())
+    {
+        const unsigned char* head = reinterpret_cast < const unsigned char* >(mBuffer.data()) + mScanned;
+        std::size_t available = mBuffer.size() - mScanned;
+        ItemHead item;
+
+        bool complete = mFormat == B_CBOR ? scanCBOR(head, available, mOffset + mScanned, item)
+                                          : scanMessagePack(head, available, mOffset + mScanned, item);
+
+        if (!complete || item.size > available)
+            break;
+
+        mScanned = mScanned + item.size;
+
+        if (item.isBreak)
+        {
+            JSON_THROW_IF(mPending.empty() || mPending.back() != ~std::uint64_t(0),
+            Exception("CBOR(%zu): unexpected break.", mOffset + mScanned - 1));
+
+            mPending.pop_back();
+            endItem();
+        }
+
+        else if (item.items)
+            mPending.push_back(item.items);
+
+        else
+            endItem();
+    }
+
+    mBuffer.erase(0, mStart);
+    mOffset = mOffset + mStart;
+    mScanned = mScanned - mStart;
+    mStart = 0;
+}
+
+void JSON::BinaryPushParser::finish()
+{
+    JSON_THROW_IF(!mBuffer.empty(), Exception("%s(%zu): unexpected end of data.",
+                                              mFormat == B_CBOR ? "CBOR" : "MessagePack", mOffset + mBuffer.size()));
+
+    mPending.clear();
+    mStart = 0;
+    mScanned = 0;
+    mOffset = 0;
+}
@@ -0,0 +1,223 @@
+// JSONCursor.cpp
+// The typed reader of the JSON Parser.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+#include "JSONScanner.h"
+#include "JSONReader.h"
+
+#include <cctype>
+
+JSON::Cursor::Cursor(std::string_view content)
+: mReader(new Reader(content, nullptr, S_COPY))
+{
+
+}
+
+JSON::Cursor::~Cursor()
+{
+
+}
+
+char JSON::Cursor::peek()
+{
+    mReader->findFirstCharacter();
+    return mReader->current();
+}
+
+void JSON::Cursor::advance()
+{
+    mReader->mPos = mReader->mPos + 1;
+    mReader->mCol = mReader->mCol + 1;
+}
+
+void JSON::Cursor::beginObject()
+{
+    JSON_THROW_IF(peek() != '{', Exception("Parser(%i:%i): expected '{'.", mReader->mLine, mReader->mCol));
+    advance();
+}
+
+bool JSON::Cursor::nextKey(bool first, std::string_view& key)
+{
+    char c = peek();
+
+    if (c == '}')
+    {
+        advance();
+        return false;
+    }
+
+    if (!first)
+    {
+        JSON_THROW_IF(c != ',', Exception("Parser(%i:%i): unexpected character %c.", mReader->mLine, mReader->mCol, c));
+        advance();
+        peek();
+    }
+
+    bool escaped;
+    key = mReader->readKey(escaped);
+    return true;
+}
+
+void JSON::Cursor::beginArray()
+{
+    JSON_THROW_IF(peek() != '[', Exception("Parser(%i:%i): expected '['.", mReader->mLine, mReader->mCol));
+    advance();
+}
+
+bool JSON::Cursor::nextElement(bool first)
+{
+    char c = peek();
+
+    if (c == ']')
+    {
+        advance();
+        return false;
+    }
+
+    if (!first)
+    {
+        JSON_THROW_IF(c != ',', Exception("Parser(%i:%i): unexpected character %c.", mReader->mLine, mReader->mCol, c));
+        advance();
+    }
+
+    return true;
+}
+
+std::int64_t JSON::Cursor::readInteger(std::int64_t min, std::int64_t max)
+{
+    Value value;
+    peek();
+
+    std::size_t line = mReader->mLine, col = mReader->mCol;
+    mReader->readNumber(value);
+    advance();
+
+    // Integers above the range of std::int64_t are stored unsigned.
+    JSON_THROW_IF(!value.isInteger(), Exception("Parser(%i:%i): expected an integer.", line, col));
+    JSON_THROW_IF(value.toDouble() >= 0x1p63 || value.toInt64() < min || value.toInt64() > max,
+                  Exception("Parser(%i:%i): integer out of range.", line, col));
+    return value.toInt64();
+}
+
+std::uint64_t JSON::Cursor::readUnsigned(std::uint64_t max)
+{
+    Value value;
+    peek();
+
+    std::size_t line = mReader->mLine, col = mReader->mCol;
+    mReader->readNumber(value);
+    advance();
+
+    JSON_THROW_IF(!value.isInteger(), Exception("Parser(%i:%i): expected an integer.", line, col));
+    JSON_THROW_IF(value.toDouble() < 0 || value.toUInt64() > max, Exception("Parser(%i:%i): integer out of range.",
+                                                                            line, col));
+    return value.toUInt64();
+}
+
+double JSON::Cursor::readNumber()
+{
+    Value value;
+    peek();
+
+    mReader->readNumber(value);
+    advance();
+    return value.toDouble();
+}
+
+bool JSON::Cursor::readBoolean()
+{
+    peek();
+
+    bool value = mReader->readBoolean();
+    advance();
+    return value;
+}
+
+bool JSON::Cursor::readNull()
+{
+    if (peek() != 'n')
+        return false;
+
+    mReader->readNull();
+    advance();
+    return true;
+}
+
+void JSON::Cursor::readString(std::string& string)
+{
+    peek();
+
+    bool escaped;
+    string.assign(mReader->parseString(escaped));
+    advance();
+}
+
+void JSON::Cursor::readObject(JSON& object)
+{
+    JSON_THROW_IF(peek() != '{', Exception("Parser(%i:%i): expected '{'.", mReader->mLine, mReader->mCol));
+
+    object = mReader->readObject();
+    advance();
+}
+
+void JSON::Cursor::readValue(Value& value)
+{
+    peek();
+
+    value = mReader->readValueContent(std::string_view(), false);
+    advance();
+}
+
+void JSON::Cursor::skip()
+{
+    std::string_view key;
+
+    switch (peek())
+    {
+        case '{':
+            beginObject();
+
+            for (bool first = true; nextKey(first, key); first = false)
+                skip();
+
+            break;
+
+        case '[':
+            beginArray();
+
+            for (bool first = true; nextElement(first); first = false)
+                skip();
+
+            break;
+
+        case '"':
+        {
+            // Strings without escapes are not copied anywhere.
+            bool escaped;
+            mReader->parseString(escaped);
+            advance();
+            break;
+        }
+
+        case 't':
+        case 'f':
+            readBoolean();
+            break;
+
+        case 'n':
+            readNull();
+            break;
+
+        default:
+            readNumber();
+    }
+}
+
+void JSON::Cursor::finish()
+{
+    // checkEnd() looks past the current character, the last one read.
+    mReader->mPos = mReader->mPos - 1;
+    mReader->mCol = mReader->mCol - 1;
+    mReader->checkEnd();
+}
@@ -0,0 +1,660 @@
+// JSONImage.cpp
+// The images of documents, read in place by MappedDocument.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+#   include <cerrno>
+#   include <cstdlib>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   define JSON_HAS_FSYNC 1
+#endif
+
+// An image is a header followed by blocks aligned on 8 bytes, in the byte order of the
+// machine that wrote it:
+// - the node of the top-level object;
+// - for each object, the key ids of its members, their nodes, and for objects larger than
+//   JSON_INDEX_THRESHOLD the positions of the members sorted by key;
+// - for each array, the nodes of its elements;
+// - the bytes of the strings, where they are met;
+// - the key table, the offset and length of each distinct key, and the bytes of the keys.
+
+//! @brief The magic of an image, followed by its version.
+static const char ImageMagic[8] = { 'J', 'S', 'O', 'N', 'P', 'P', 'I', 'M' };
+static const std::uint32_t ImageVersion = 1;
+
+//! @brief Written in the byte order of the machine, read back the same on machines sharing it.
+static const std::uint32_t ImageOrder = 0x01020304;
+
+//! @brief The header of an image.
+struct ImageHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t order;
+
+    //! @brief The size of the image.
+    std::uint64_t size;
+
+    //! @brief The offset of the root node.
+    std::uint64_t root;
+
+    //! @brief The offset of the key table, and its number of keys.
+    std::uint64_t keys;
+    std::uint64_t keyCount;
+};
+
+//! @brief The types of nodes.
+enum ImageType : std::uint8_t { I_OBJECT, I_ARRAY, I_STRING, I_INTEGER, I_UNSIGNED, I_NUMBER, I_TRUE, I_FALSE, I_NULL };
+
+//! @brief A value in an image.
+struct ImageNode
+{
+    //! @brief The type, an ImageType.
+    std::uint8_t type;
+    std::uint8_t reserved[3];
+
+    //! @brief The number of members or elements, or the length of the string.
+    std::uint32_t count;
+
+    //! @brief The offset of the members, the elements or the string, or the number or the integer.
+    std::uint64_t payload;
+};
+
+//! @brief A key in the key table.
+struct ImageKey
+{
+    std::uint64_t offset;
+    std::uint64_t length;
+};
+
+static_assert(sizeof(ImageHeader) == 48 && sizeof(ImageNode) == 16 && sizeof(ImageKey) == 16,
+              "image structures must not be padded.");
+
+//! @brief Returns the size of the key ids of count members, padded to 8 bytes.
+static std::uint64_t idsSize(std::uint64_t count)
+{
+    return (4 * count + 7) & ~std::uint64_t(7);
+}
+
+//! @brief Lays a document out into an image.
+class ImageBuilder
+{
+    //! @brief The image.
+    std::string mImage;
+
+    //! @brief The id of each distinct key, viewing the document.
+    std::unordered_map < std::string_view, std::uint32_t > mIds;
+
+    //! @brief The distinct keys, by id.
+    std::vector < std::string_view > mKeys;
+
+    //! @brief Appends a block of size bytes, aligned on 8 bytes, and returns its offset.
+    std::uint64_t allocate(std::uint64_t size)
+    {
+        std::uint64_t offset = (mImage.size() + 7) & ~std::uint64_t(7);
+        mImage.resize(offset + size);
+        return offset;
+    }
+
+    //! @brief Copies the bytes to offset.
+    void store(std::uint64_t offset, const void* data, std::size_t size)
+    {
+        if (size)
+            std::memcpy(&mImage[offset], data, size);
+    }
+
+    //! @brief Returns the id of the key, giving it one if it is new.
+    std::uint32_t idOf(std::string_view key)
+    {
+        auto it = mIds.find(key);
+
+        if (it != mIds.end())
+            return it->second;
+
+        JSON_THROW_IF(mKeys.size() >= UINT32_MAX, JSON::Exception("Image: more than 4G distinct keys."));
+
+        mKeys.push_back(key);
+        return mIds.emplace(key, static_cast < std::uint32_t >(mKeys.size() - 1)).first->second;
+    }
+
+    //! @brief Returns the count, checking it fits in a node.
+    static std::uint32_t countOf(std::size_t count)
+    {
+        JSON_THROW_IF(count > UINT32_MAX, JSON::Exception("Image: %zu members, elements or bytes do not fit in a node.", count));
+        return static_cast < std::uint32_t >(count);
+    }
+
+    //! @brief Writes the members of the object and returns the offset of their block.
+    std::uint64_t writeObject(const JSON& object)
+    {
+        std::uint32_t count = countOf(std::distance(object.begin(), object.end()));
+        bool sorted = count > JSON_INDEX_THRESHOLD;
+        std::uint64_t block = allocate(idsSize(count) + sizeof(ImageNode) * count + (sorted ? 4 * count : 0));
+        std::uint64_t nodes = block + idsSize(count);
+
+        std::vector < std::uint32_t > ids(count);
+        std::size_t i = 0;
+
+        for (const JSON::Value& value : object)
+            ids[i++] = idOf(value.name());
+
+        store(block, ids.data(), 4 * count);
+
+        if (sorted)
+        {
+            std::vector < std::uint32_t > positions(count);
+
+            for (std::uint32_t p = 0; p < count; ++p)
+                positions[p] = p;
+
+            // Stable: the first of duplicate members is found, like in the document.
+            std::stable_sort(positions.begin(), positions.end(), [this, &ids](std::uint32_t a, std::uint32_t b)
+            {
+                return mKeys[ids[a]] < mKeys[ids[b]];
+            });
+
+            store(nodes + sizeof(ImageNode) * count, positions.data(), 4 * count);
+        }
+
+        i = 0;
+
+        for (const JSON::Value& value : object)
+            writeNode(nodes + sizeof(ImageNode) * i++, value);
+
+        return block;
+    }
+
+public:
+    //! @brief Writes the node of the value at offset, and what it holds after the image.
+    void writeNode(std::uint64_t offset, const JSON::Value& value)
+    {
+        ImageNode node = {};
+
+        if (value.isObject())
+        {
+            node.type = I_OBJECT;
+            node.count = countOf(std::distance(value.toObject().begin(), value.toObject().end()));
+            node.payload = writeObject(value.toObject());
+        }
+
+        else if (value.isArray())
+        {
+            const JSON::Array& array = value.toArray();
+            node.type = I_ARRAY;
+            node.count = countOf(array.size());
+            node.payload = allocate(sizeof(ImageNode) * array.size());
+
+            for (std::size_t i = 0; i < array.size(); ++i)
+                writeNode(node.payload + sizeof(ImageNode) * i, array[i]);
+        }
+
+        else if (value.isString())
+        {
+            std::string_view string = value.toStringView();
+            node.type = I_STRING;
+            node.count = countOf(string.size());
+            node.payload = mImage.size();
+            mImage.append(string);
+        }
+
+        else if (value.isInteger())
+        {
+            // Negative integers always fit in std::int64_t.
+            if (value.toNumber() < 0)
+            {
+                node.type = I_INTEGER;
+                node.payload = static_cast < std::uint64_t >(value.toInt64());
+            }
+
+            else
+            {
+                node.payload = value.toUInt64();
+                node.type = node.payload > INT64_MAX ? I_UNSIGNED : I_INTEGER;
+            }
+        }
+
+        else if (value.isNumber())
+        {
+            double number = value.toNumber();
+            node.type = I_NUMBER;
+            std::memcpy(&node.payload, &number, sizeof(number));
+        }
+
+        else if (value.isBoolean())
+            node.type = value.toBoolean() ? I_TRUE : I_FALSE;
+
+        else
+            node.type = I_NULL;
+
+        store(offset, &node, sizeof(node));
+    }
+
+    //! @brief Lays the document out and returns the image.
+    std::string build(const JSON& document)
+    {
+        std::uint64_t header = allocate(sizeof(ImageHeader));
+        std::uint64_t root = allocate(sizeof(ImageNode));
+
+        ImageNode node = {};
+        node.type = I_OBJECT;
+        node.count = countOf(std::distance(document.begin(), document.end()));
+        node.payload = writeObject(document);
+        store(root, &node, sizeof(node));
+
+        std::uint64_t keys = allocate(sizeof(ImageKey) * mKeys.size());
+
+        for (std::size_t i = 0; i < mKeys.size(); ++i)
+        {
+            ImageKey key = { mImage.size(), mKeys[i].size() };
+            mImage.append(mKeys[i]);
+            store(keys + sizeof(ImageKey) * i, &key, sizeof(key));
+        }
+
+        ImageHeader head;
+        std::memcpy(head.magic, ImageMagic, sizeof(ImageMagic));
+        head.version = ImageVersion;
+        head.order = ImageOrder;
+        head.size = mImage.size();
+        head.root = root;
+        head.keys = keys;
+        head.keyCount = mKeys.size();
+        store(header, &head, sizeof(head));
+
+        return std::move(mImage);
+    }
+};
+
+std::string JSON::toImage() const
+{
+    return ImageBuilder().build(*this);
+}
+
+void JSON::saveImage(const std::string& file) const
+{
+    std::string image = toImage();
+
+    // Other processes may have mapped the file: truncating it would fault their next read, or
+    // show them half an image. The image is written beside it and renamed over it, and they
+    // keep reading the previous one until they open it again.
+#if JSON_HAS_FSYNC
+    std::string temporary = file + ".XXXXXX";
+    int fd = ::mkstemp(&temporary[0]);
+    JSON_THROW_IF(fd < 0, Exception("cannot open output file %s.", file.data()));
+
+    // The image keeps the mode of the file it replaces, readable by all otherwise.
+    struct stat info;
+    ::fchmod(fd, ::stat(file.data(), &info) == 0 ? info.st_mode & 07777 : 0644);
+
+    const char* data = image.data();
+    std::size_t left = image.size();
+
+    while (left)
+    {
+        ssize_t written = ::write(fd, data, left);
+
+        if (written < 0 && errno == EINTR)
+            continue;
+
+        if (written <= 0)
+            break;
+
+        data += written;
+        left -= written;
+    }
+
+    bool failed = left || ::fsync(fd) != 0;
+    failed = ::close(fd) != 0 || failed;
+
+    if (failed || std::rename(temporary.data(), file.data()) != 0)
+    {
+        ::unlink(temporary.data());
+        JSON_THROW(Exception("cannot write output file %s.", file.data()));
+    }
+#else
+    std::string temporary = file + ".tmp";
+    std::ofstream stream(temporary.data(), std::ios::out | std::ios::binary | std::ios::trunc);
+    JSON_THROW_IF(!stream, Exception("cannot open output file %s.", file.data()));
+
+    stream.write(image.data(), static_cast < std::streamsize >(image.size()));
+    stream.close();
+
+    std::error_code error;
+
+    if (stream)
+        std::filesystem::rename(temporary, file, error);
+
+    if (!stream || error)
+    {
+        std::filesystem::remove(temporary, error);
+        JSON_THROW(Exception("cannot write output file %s.", file.data()));
+    }
+#endif
+}
+
+JSON::MappedDocument::MappedDocument(std::string_view image)
+: mImage(image)
+, mKeys(0)
+, mKeyCount(0)
+, mRoot(0)
+{
+    JSON_THROW_IF(image.size() < sizeof(ImageHeader) || std::memcmp(image.data(), ImageMagic, sizeof(ImageMagic)) != 0,
+                  Exception("MappedDocument: not an image."));
+
+    ImageHeader head;
+    std::memcpy(&head, image.data(), sizeof(head));
+
+    JSON_THROW_IF(head.order != ImageOrder, Exception("MappedDocument: image of another byte order."));
+    JSON_THROW_IF(head.version != ImageVersion, Exception("MappedDocument: unsupported image version %u.", head.version));
+    JSON_THROW_IF(head.size != image.size(), Exception("MappedDocument: truncated image."));
+    JSON_THROW_IF(head.keyCount > (image.size() - std::min < std::uint64_t >(head.keys, image.size())) / sizeof(ImageKey),
+                  Exception("MappedDocument: key table out of the image."));
+
+    mKeys = head.keys;
+    mKeyCount = head.keyCount;
+    mRoot = head.root;
+
+    JSON_THROW_IF(!root().isObject(), Exception("MappedDocument: the top-level value is not an object."));
+}
+
+void JSON::MappedDocument::read(std::uint64_t offset, void* data, std::size_t size) const
+{
+    JSON_THROW_IF(offset > mImage.size() || size > mImage.size() - offset,
+                  Exception("MappedDocument: offset %llu out of the image.", static_cast < unsigned long long >(offset)));
+
+    std::memcpy(data, mImage.data() + offset, size);
+}
+
+std::string_view JSON::MappedDocument::key(std::uint32_t id) const
+{
+    JSON_THROW_IF(id >= mKeyCount, Exception("MappedDocument: key %u out of the key table.", id));
+
+    ImageKey key;
+    read(mKeys + sizeof(ImageKey) * id, &key, sizeof(key));
+
+    JSON_THROW_IF(key.offset > mImage.size() || key.length > mImage.size() - key.offset,
+                  Exception("MappedDocument: key %u out of the image.", id));
+
+    return mImage.substr(key.offset, key.length);
+}
+
+JSON::MappedValue JSON::MappedDocument::root() const
+{
+    return MappedValue(this, mRoot);
+}
+
+JSON::MappedValue JSON::MappedDocument::operator [](std::string_view name) const
+{
+    return root()[name];
+}
+
+JSON::MappedValue::MappedValue()
+: mDocument(nullptr)
+, mNode(0)
+{
+
+}
+
+JSON::MappedValue::MappedValue(const MappedDocument* document, std::uint64_t node)
+: mDocument(document)
+, mNode(node)
+{
+
+}
+
+unsigned JSON::MappedValue::type() const
+{
+    if (!mDocument)
+        return I_NULL;
+
+    std::uint8_t type;
+    mDocument->read(mNode, &type, sizeof(type));
+    return type;
+}
+
+std::uint64_t JSON::MappedValue::block(std::size_t& count) const
+{
+    ImageNode node;
+    count = 0;
+
+    if (!mDocument)
+        return 0;
+
+    mDocument->read(mNode, &node, sizeof(node));
+
+    if (node.type != I_OBJECT && node.type != I_ARRAY)
+        return 0;
+
+    // Blocks always follow their node: a corrupted image cannot make values hold themselves.
+    JSON_THROW_IF(node.payload <= mNode, Exception("MappedDocument: node at offset %llu points backwards.",
+                                                   static_cast < unsigned long long >(mNode)));
+
+    count = node.count;
+    return node.payload;
+}
+
+bool JSON::MappedValue::isObject() const
+{
+    return type() == I_OBJECT;
+}
+
+bool JSON::MappedValue::isNumber() const
+{
+    unsigned kind = type();
+    return kind == I_INTEGER || kind == I_UNSIGNED || kind == I_NUMBER;
+}
+
+bool JSON::MappedValue::isString() const
+{
+    return type() == I_STRING;
+}
+
+bool JSON::MappedValue::isArray() const
+{
+    return type() == I_ARRAY;
+}
+
+bool JSON::MappedValue::isBoolean() const
+{
+    unsigned kind = type();
+    return kind == I_TRUE || kind == I_FALSE;
+}
+
+bool JSON::MappedValue::isNull() const
+{
+    return type() == I_NULL;
+}
+
+std::size_t JSON::MappedValue::size() const
+{
+    std::size_t count;
+    block(count);
+    return count;
+}
+
+JSON::MappedValue JSON::MappedValue::at(std::size_t index) const
+{
+    std::size_t count;
+    std::uint64_t nodes = block(count);
+
+    if (index >= count)
+        return MappedValue();
+
+    // The nodes of the members follow their key ids.
+    if (isObject())
+        nodes = nodes + idsSize(count);
+
+    return MappedValue(mDocument, nodes + sizeof(ImageNode) * index);
+}
+
+std::string_view JSON::MappedValue::key(std::size_t index) const
+{
+    std::size_t count;
+    std::uint64_t ids = block(count);
+
+    if (!isObject() || index >= count)
+        return std::string_view();
+
+    std::uint32_t id;
+    mDocument->read(ids + 4 * index, &id, sizeof(id));
+    return mDocument->key(id);
+}
+
+JSON::MappedValue JSON::MappedValue::operator [](std::string_view name) const
+{
+    if (!isObject())
+        return MappedValue();
+
+    std::size_t count;
+    std::uint64_t ids = block(count), nodes = ids + idsSize(count);
+    std::uint32_t id;
+
+    if (count <= JSON_INDEX_THRESHOLD)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            mDocument->read(ids + 4 * i, &id, sizeof(id));
+
+            if (mDocument->key(id) == name)
+                return MappedValue(mDocument, nodes + sizeof(ImageNode) * i);
+        }
+
+        return MappedValue();
+    }
+
+    // Larger objects are searched through the positions of their members sorted by key.
+    std::uint64_t positions = nodes + sizeof(ImageNode) * count;
+    std::size_t low = 0, high = count;
+    std::uint32_t position = 0;
+
+    while (low < high)
+    {
+        std::size_t middle = low + (high - low) / 2;
+        mDocument->read(positions + 4 * middle, &position, sizeof(position));
+        mDocument->read(ids + 4 * std::uint64_t(position), &id, sizeof(id));
+
+        if (mDocument->key(id) < name)
+            low = middle + 1;
+
+        else
+            high = middle;
+    }
+
+    if (low == count)
+        return MappedValue();
+
+    mDocument->read(positions + 4 * low, &position, sizeof(position));
+    mDocument->read(ids + 4 * std::uint64_t(position), &id, sizeof(id));
+
+    return position < count && mDocument->key(id) == name ? MappedValue(mDocument, nodes + sizeof(ImageNode) * position)
+                                                           : MappedValue();
+}
+
+std::string_view JSON::MappedValue::toString() const
+{
+    JSON_THROW_IF(!isString(), Exception("invalid toString() type conversion."));
+
+    ImageNode node;
+    mDocument->read(mNode, &node, sizeof(node));
+
+    JSON_THROW_IF(node.payload > mDocument->mImage.size() || node.count > mDocument->mImage.size() - node.payload,
+                  Exception("MappedDocument: string out of the image."));
+
+    return mDocument->mImage.substr(node.payload, node.count);
+}
+
+double JSON::MappedValue::toDouble() const
+{
+    JSON_THROW_IF(!isNumber(), Exception("invalid toDouble() type conversion."));
+    return toValue().toDouble();
+}
+
+std::int64_t JSON::MappedValue::toInt64() const
+{
+    JSON_THROW_IF(!isNumber(), Exception("invalid toInt64() type conversion."));
+    return toValue().toInt64();
+}
+
+std::uint64_t JSON::MappedValue::toUInt64() const
+{
+    JSON_THROW_IF(!isNumber(), Exception("invalid toUInt64() type conversion."));
+    return toValue().toUInt64();
+}
+
+bool JSON::MappedValue::toBoolean() const
+{
+    JSON_THROW_IF(!isBoolean(), Exception("invalid toBoolean() type conversion."));
+    return type() == I_TRUE;
+}
+
+JSON::Value JSON::MappedValue::toValue() const
+{
+    return toValue(std::string_view());
+}
+
+JSON::Value JSON::MappedValue::toValue(std::string_view name) const
+{
+    if (!mDocument)
+        return Value(name);
+
+    ImageNode node;
+    mDocument->read(mNode, &node, sizeof(node));
+
+    switch (node.type)
+    {
+        case I_OBJECT:
+        {
+            JSON object;
+            std::size_t count = size();
+
+            for (std::size_t i = 0; i < count; ++i)
+                object.addValue(at(i).toValue(key(i)));
+
+            return Value(name, std::move(object));
+        }
+
+        case I_ARRAY:
+        {
+            Array array;
+            std::size_t count = size();
+            array.reserve(count);
+
+            for (std::size_t i = 0; i < count; ++i)
+                array.push_back(at(i).toValue(std::string_view()));
+
+            return Value(name, std::move(array));
+        }
+
+        case I_STRING:
+            return Value(name, std::string(toString()));
+
+        case I_INTEGER:
+            return Value(name, static_cast < std::int64_t >(node.payload));
+
+        case I_UNSIGNED:
+            return Value(name, node.payload);
+
+        case I_NUMBER:
+        {
+            double number;
+            std::memcpy(&number, &node.payload, sizeof(number));
+            return Value(name, Number(number));
+        }
+
+        case I_TRUE:
+        case I_FALSE:
+            return Value(name, node.type == I_TRUE);
+
+        default:
+            return Value(name);
+    }
+}
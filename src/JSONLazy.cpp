@@ -0,0 +1,364 @@
+// JSONLazy.cpp
+// The lazy documents of the JSON Parser.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+#include "JSONScanner.h"
+#include "JSONReader.h"
+
+#include <climits>
+
+//! @brief Returns the line and column of the offset in the content, for error messages.
+static void positionOf(std::string_view content, std::size_t offset, std::size_t& line, std::size_t& col)
+{
+    line = 0;
+    col = 0;
+
+    for (std::size_t i = 0; i < offset && i < content.size(); ++i)
+    {
+        if (content[i] == '\n')
+        {
+            line = line + 1;
+            col = 0;
+        }
+
+        else
+            col = col + 1;
+    }
+}
+
+JSON::LazyDocument::LazyDocument(std::string_view content)
+: mContent(content)
+{
+    JSON_THROW_IF(content.size() > UINT32_MAX, Exception("LazyDocument: content larger than 4GB."));
+
+    const char* begin = content.data(), *end = begin + content.size();
+    std::vector < std::uint32_t > opened;
+    std::size_t line, col;
+
+    mStructurals.reserve(content.size() / 8);
+    opened.reserve(64);
+
+    for (const char* it = Scanner::findStructural(begin, end); it < end; it = Scanner::findStructural(it + 1, end))
+    {
+        std::uint32_t index = static_cast < std::uint32_t >(mStructurals.size());
+        mStructurals.push_back(Structural{ static_cast < std::uint32_t >(it - begin), 0 });
+
+        switch (*it)
+        {
+            case '"':
+            {
+                // Skips the string up to its closing quote, which is recorded too.
+                const char* close = Scanner::findQuoteOrEscape(it + 1, end);
+
+                while (close < end && *close == '\\')
+                    close = Scanner::findQuoteOrEscape(close + 2 < end ? close + 2 : end, end);
+
+                if (close == end)
+                {
+                    positionOf(content, it - begin, line, col);
+                    JSON_THROW(Exception("Parser(%i:%i): unexpected EOF.", line, col));
+                }
+
+                mStructurals.push_back(Structural{ static_cast < std::uint32_t >(close - begin), 0 });
+                it = close;
+                break;
+            }
+
+            case '{':
+            case '[':
+                opened.push_back(index);
+                break;
+
+            case '}':
+            case ']':
+            {
+                bool matches = !opened.empty() && begin[mStructurals[opened.back()].offset] == (*it == '}' ? '{' : '[');
+
+                if (!matches)
+                {
+                    positionOf(content, it - begin, line, col);
+                    JSON_THROW(Exception("Parser(%i:%i): unexpected character %c.", line, col, *it));
+                }
+
+                mStructurals[opened.back()].match = index;
+                opened.pop_back();
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    if (!opened.empty())
+    {
+        positionOf(content, mStructurals[opened.back()].offset, line, col);
+        JSON_THROW(Exception("Parser(%i:%i): unexpected EOF, %c is not closed.", line, col,
+                             begin[mStructurals[opened.back()].offset]));
+    }
+}
+
+JSON::LazyValue JSON::LazyDocument::root() const
+{
+    Scanner::Lines lines;
+    const char* begin = mContent.data(), *end = begin + mContent.size();
+    const char* first = Scanner::skipWhitespace(begin, end, lines);
+
+    if (first == end)
+        return LazyValue();
+
+    return LazyValue(this, static_cast < std::uint32_t >(first - begin), 0);
+}
+
+JSON::LazyValue JSON::LazyDocument::operator[](std::string_view name) const
+{
+    return root()[name];
+}
+
+JSON::LazyValue::LazyValue()
+: mDocument(nullptr)
+, mBegin(0)
+, mStructural(0)
+{
+
+}
+
+JSON::LazyValue::LazyValue(const LazyDocument* document, std::uint32_t begin, std::uint32_t structural)
+: mDocument(document)
+, mBegin(begin)
+, mStructural(structural)
+{
+
+}
+
+char JSON::LazyValue::first() const
+{
+    return mDocument && mBegin < mDocument->mContent.size() ? mDocument->mContent[mBegin] : '\0';
+}
+
+std::uint32_t JSON::LazyValue::next() const
+{
+    switch (first())
+    {
+        case '{':
+        case '[':
+            return mDocument->mStructurals[mStructural].match + 1;
+
+        case '"':
+            return mStructural + 2;
+
+        default:
+            return mStructural;
+    }
+}
+
+JSON::LazyValue JSON::LazyValue::valueAfter(std::uint32_t structural) const
+{
+    std::string_view content = mDocument->mContent;
+    const char* after = content.data() + mDocument->mStructurals[structural].offset + 1;
+
+    Scanner::Lines lines;
+    const char* first = Scanner::skipWhitespace(after, content.data() + content.size(), lines);
+
+    return LazyValue(mDocument, static_cast < std::uint32_t >(first - content.data()), structural + 1);
+}
+
+JSON::Reader JSON::LazyValue::reader() const
+{
+    // A scalar is read up to the structural following it, strings and containers whole.
+    const auto& structurals = mDocument->mStructurals;
+    std::string_view content = mDocument->mContent;
+    char c = first();
+
+    if (c != '"' && c != '{' && c != '[' && mStructural < structurals.size())
+        content = content.substr(0, structurals[mStructural].offset);
+
+    Reader reader(content, nullptr, S_COPY);
+    reader.mPos = mBegin;
+    return reader;
+}
+
+bool JSON::LazyValue::isObject() const
+{
+    return first() == '{';
+}
+
+bool JSON::LazyValue::isNumber() const
+{
+    return first() == '-' || std::isdigit(static_cast < unsigned char >(first()));
+}
+
+bool JSON::LazyValue::isString() const
+{
+    return first() == '"';
+}
+
+bool JSON::LazyValue::isArray() const
+{
+    return first() == '[';
+}
+
+bool JSON::LazyValue::isBoolean() const
+{
+    return first() == 't' || first() == 'f';
+}
+
+bool JSON::LazyValue::isNull() const
+{
+    return !mDocument || first() == 'n';
+}
+
+JSON::LazyValue JSON::LazyValue::operator[](std::string_view name) const
+{
+    if (!isObject())
+        return LazyValue();
+
+    const auto& structurals = mDocument->mStructurals;
+    std::string_view content = mDocument->mContent;
+    std::uint32_t end = structurals[mStructural].match;
+
+    for (std::uint32_t s = mStructural + 1; s < end;)
+    {
+        std::uint32_t keyBegin = structurals[s].offset;
+
+        JSON_THROW_IF(content[keyBegin] != '"' || s + 2 >= end || content[structurals[s + 2].offset] != ':',
+        Exception("Parser: malformed member at offset %u.", static_cast < unsigned >(keyBegin)));
+
+        std::string_view key = content.substr(keyBegin + 1, structurals[s + 1].offset - keyBegin - 1);
+        LazyValue value = valueAfter(s + 2);
+
+        if (key.find('\\') == std::string_view::npos)
+        {
+            if (key == name)
+                return value;
+        }
+
+        else
+        {
+            Reader reader(content.substr(0, structurals[s + 1].offset + 1), nullptr, S_COPY);
+            reader.mPos = keyBegin;
+
+            bool escaped;
+            if (reader.parseString(escaped) == name)
+                return value;
+        }
+
+        // Skips the value whole, then its ','.
+        s = value.next() + 1;
+    }
+
+    return LazyValue();
+}
+
+JSON::LazyValue JSON::LazyValue::at(std::size_t index) const
+{
+    if (!isArray())
+        return LazyValue();
+
+    const auto& structurals = mDocument->mStructurals;
+    std::uint32_t end = structurals[mStructural].match;
+
+    for (std::uint32_t s = mStructural; s < end; --index)
+    {
+        LazyValue element = valueAfter(s);
+
+        // An empty array, or a trailing ','.
+        if (element.mBegin == structurals[end].offset)
+            break;
+
+        if (index == 0)
+            return element;
+
+        s = element.next();
+    }
+
+    return LazyValue();
+}
+
+std::size_t JSON::LazyValue::size() const
+{
+    if (!isObject() && !isArray())
+        return 0;
+
+    const auto& structurals = mDocument->mStructurals;
+    std::uint32_t end = structurals[mStructural].match;
+    std::size_t count = 0;
+
+    if (isObject())
+    {
+        // Each member is a key, a ':' and a value, followed by a ',' or the '}'.
+        for (std::uint32_t s = mStructural + 1; s < end; s = valueAfter(s + 2).next() + 1)
+            count = count + 1;
+    }
+
+    else
+    {
+        for (std::uint32_t s = mStructural; s < end; count = count + 1)
+        {
+            LazyValue element = valueAfter(s);
+
+            if (element.mBegin == structurals[end].offset)
+                break;
+
+            s = element.next();
+        }
+    }
+
+    return count;
+}
+
+std::string JSON::LazyValue::toString() const
+{
+    JSON_THROW_IF(!isString(), Exception("invalid toString() type conversion."));
+
+    bool escaped;
+    Reader input = reader();
+    return std::string(input.parseString(escaped));
+}
+
+double JSON::LazyValue::toDouble() const
+{
+    JSON_THROW_IF(!isNumber(), Exception("invalid toDouble() type conversion."));
+    return toValue().toDouble();
+}
+
+std::int64_t JSON::LazyValue::toInt64() const
+{
+    JSON_THROW_IF(!isNumber(), Exception("invalid toInt64() type conversion."));
+    return toValue().toInt64();
+}
+
+std::uint64_t JSON::LazyValue::toUInt64() const
+{
+    JSON_THROW_IF(!isNumber(), Exception("invalid toUInt64() type conversion."));
+    return toValue().toUInt64();
+}
+
+bool JSON::LazyValue::toBoolean() const
+{
+    JSON_THROW_IF(!isBoolean(), Exception("invalid toBoolean() type conversion."));
+    return toValue().toBoolean();
+}
+
+JSON::Value JSON::LazyValue::toValue() const
+{
+    if (!mDocument)
+        return Value();
+
+    Reader input = reader();
+    Value value = input.readValueContent(std::string_view(), false);
+
+    // A scalar must be followed by whitespaces only, up to its structural.
+    if (!isObject() && !isArray() && !isString())
+    {
+        Scanner::Lines lines;
+        const char* end = input.mContent.data() + input.mContent.size();
+        const char* stop = Scanner::skipWhitespace(input.mContent.data() + input.mPos + 1, end, lines);
+
+        JSON_THROW_IF(stop != end, Exception("Parser: unexpected character %c at offset %u.",
+                                             *stop, static_cast < unsigned >(stop - input.mContent.data())));
+    }
+
+    return value;
+}
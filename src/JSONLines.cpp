@@ -0,0 +1,175 @@
+// JSONLines.cpp
+// The parallel loader of JSON Lines.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+#include "JSONScanner.h"
+#include "JSONReader.h"
+#include "JSONPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+//! @brief A part of the content, made of whole lines.
+struct LinesChunk
+{
+    //! @brief The lines of the chunk.
+    std::string_view content;
+
+    //! @brief The records parsed out of the lines, until they are sent.
+    std::vector < JSON > records;
+
+    //! @brief The offset of the invalid line in the content, if the error is a parser one.
+    std::size_t errorOffset = std::string_view::npos;
+
+    //! @brief The error met parsing or sending the records, if any.
+    std::exception_ptr error;
+
+    //! @brief True once the chunk is parsed.
+    bool done = false;
+};
+
+std::vector < JSON > JSON::loadLinesContent(std::string_view content, unsigned threads)
+{
+    // Records come in order: appending them is enough.
+    std::vector < JSON > records;
+    loadLinesContent(content, [&records](JSON&& record) { records.push_back(std::move(record)); }, threads);
+    return records;
+}
+
+void JSON::loadLinesContent(std::string_view content, const RecordCallback& callback, unsigned threads)
+{
+    if (!threads)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Small contents are still split in a few chunks per thread, for the threads to share them.
+    std::size_t chunkSize = std::max < std::size_t >(std::min < std::size_t >(JSON_LINES_CHUNK,
+                                                                              content.size() / (8 * threads)), 4096);
+
+    std::vector < LinesChunk > chunks;
+    chunks.reserve(content.size() / chunkSize + 1);
+
+    for (std::size_t begin = 0; begin < content.size();)
+    {
+        std::size_t end = content.size();
+
+        if (content.size() - begin > chunkSize)
+        {
+            const void* newline = std::memchr(content.data() + begin + chunkSize, '\n', content.size() - begin - chunkSize);
+
+            if (newline)
+                end = static_cast < const char* >(newline) - content.data() + 1;
+        }
+
+        chunks.emplace_back();
+        chunks.back().content = content.substr(begin, end - begin);
+        begin = end;
+    }
+
+    if (chunks.empty())
+        return;
+
+    std::mutex sending;
+    std::size_t next = 0;
+
+    // The first chunk with an error: the chunks after it are not parsed anymore.
+    std::atomic < std::size_t > failed(chunks.size());
+
+    auto parse = [&](std::size_t index)
+    {
+        LinesChunk& chunk = chunks[index];
+
+        if (index > failed.load(std::memory_order_relaxed))
+            return;
+
+        const char* line = chunk.content.data();
+        const char* end = line + chunk.content.size();
+
+        try
+        {
+            while (line < end)
+            {
+                const char* newline = static_cast < const char* >(std::memchr(line, '\n', end - line));
+                const char* stop = newline ? newline : end;
+
+                Scanner::Lines lines;
+
+                if (Scanner::skipWhitespace(line, stop, lines) != stop)
+                    chunk.records.push_back(Reader(std::string_view(line, stop - line), nullptr, S_COPY).readRecord(0));
+
+                line = stop + 1;
+            }
+        }
+
+        catch(const Exception&)
+        {
+            chunk.errorOffset = line - content.data();
+            chunk.error = std::current_exception();
+        }
+
+        catch(...)
+        {
+            chunk.error = std::current_exception();
+        }
+
+        // Sends the chunks parsed in a row from the next one to send, up to the first error.
+        std::lock_guard < std::mutex > lock(sending);
+        chunk.done = true;
+
+        if (chunk.error && index < failed.load(std::memory_order_relaxed))
+            failed.store(index, std::memory_order_relaxed);
+
+        for (; next < chunks.size() && chunks[next].done; ++next)
+        {
+            LinesChunk& ready = chunks[next];
+
+            try
+            {
+                for (JSON& record : ready.records)
+                    callback(std::move(record));
+            }
+
+            catch(...)
+            {
+                ready.error = std::current_exception();
+                ready.errorOffset = std::string_view::npos;
+            }
+
+            std::vector < JSON >().swap(ready.records);
+
+            if (ready.error)
+            {
+                if (next < failed.load(std::memory_order_relaxed))
+                    failed.store(next, std::memory_order_relaxed);
+
+                // Nothing is sent after an error.
+                next = chunks.size();
+                break;
+            }
+        }
+    };
+
+    WorkStealingPool(chunks.size(), static_cast < unsigned >(std::min < std::size_t >(threads, chunks.size())))
+    .run(parse);
+
+    if (failed == chunks.size())
+        return;
+
+    const LinesChunk& chunk = chunks[failed];
+
+    // Lines are only counted on error: the invalid line is read again to report where it is.
+    if (chunk.errorOffset != std::string_view::npos)
+    {
+        std::size_t line = std::count(content.data(), content.data() + chunk.errorOffset, '\n');
+        const void* newline = std::memchr(content.data() + chunk.errorOffset, '\n', content.size() - chunk.errorOffset);
+        std::size_t end = newline ? static_cast < const char* >(newline) - content.data() : content.size();
+
+        Reader(content.substr(chunk.errorOffset, end - chunk.errorOffset), nullptr, S_COPY).readRecord(line);
+    }
+
+    std::rethrow_exception(chunk.error);
+}
@@ -7,9 +7,15 @@
 #include <cstdarg>
 #include <cstdio>
 #include <algorithm>
-#include <sstream>
+#include <cstring>
+#include <climits>
+#include <cctype>
+#include <mutex>
+#include <unordered_set>
 
-JSON::Value JSON::NullValue = JSON::Value();
+const JSON::Value JSON::NullValue(nullptr);
+
+static_assert(sizeof(JSON::Value) <= 24, "JSON::Value should stay within three words.");
 
 JSON::Exception::Exception(const char* format, ...)
 {
@@ -26,73 +32,534 @@ const char* JSON::Exception::what() const noexcept
 	return mBuffer.data();
 }
 
-JSON::Value::Value(const std::string& name)
+JSON::FieldNames::FieldNames(const char* text)
+{
+    std::string_view names(text);
+
+    while (!names.empty())
+    {
+        std::size_t comma = std::min(names.find(','), names.size());
+        std::string_view name = names.substr(0, comma);
+
+        while (!name.empty() && std::isspace(static_cast < unsigned char >(name.front())))
+            name.remove_prefix(1);
+
+        while (!name.empty() && std::isspace(static_cast < unsigned char >(name.back())))
+            name.remove_suffix(1);
+
+        mNames.push_back(name);
+        names.remove_prefix(std::min(comma + 1, names.size()));
+    }
+
+    // Equal names would always share a slot, and the search below never end.
+    std::vector < std::string_view > sorted(mNames);
+    std::sort(sorted.begin(), sorted.end());
+    auto duplicate = std::adjacent_find(sorted.begin(), sorted.end());
+
+    JSON_THROW_IF(duplicate != sorted.end(), Exception("JSON_FIELDS(%s): field %.*s is declared twice.", text,
+                                                       static_cast < int >(duplicate->size()), duplicate->data()));
+
+    // Tries seeds until the names fall in distinct slots, in a larger table after a few.
+    for (std::size_t size = 2; ; size = size * 2)
+    {
+        if (size < 2 * mNames.size())
+            continue;
+
+        for (mSeed = 2166136261u; mSeed < 2166136261u + 64; ++mSeed)
+        {
+            mSlots.assign(size, 0);
+            std::size_t i = 0;
+
+            for (; i < mNames.size() && !mSlots[slot(mNames[i], mSeed)]; ++i)
+                mSlots[slot(mNames[i], mSeed)] = static_cast < std::uint16_t >(i + 1);
+
+            if (i == mNames.size())
+                return;
+        }
+    }
+}
+
+std::string_view JSON::FieldNames::operator[](std::size_t index) const
+{
+    return mNames[index];
+}
+
+std::size_t JSON::FieldNames::slot(std::string_view name, std::uint32_t seed) const
 {
-	mName = name;
-	mType = T_NULL;
+    // FNV-1a, starting from the seed.
+    std::uint32_t hash = seed;
+
+    for (char c : name)
+        hash = (hash ^ static_cast < unsigned char >(c)) * 16777619u;
+
+    return hash & (mSlots.size() - 1);
 }
 
-JSON::Value::Value(const std::string& name, const JSON& object)
+std::size_t JSON::FieldNames::find(std::string_view name) const
 {
-	mName = name;
-	mType = T_OBJECT;
-    mObject.reset(new JSON(object));
+    std::uint16_t index = mSlots[slot(name, mSeed)];
+    return index && mNames[index - 1] == name ? index - 1 : std::string_view::npos;
 }
 
-JSON::Value::Value(const std::string& name, const JSON::Number& number)
+JSON::Arena::Arena(std::size_t blockSize)
+: mResource(blockSize)
 {
-	mName = name;
-	mNumber = number;
-	mType = T_NUMBER;
+    
 }
 
-JSON::Value::Value(const std::string& name, const std::string& string)
+JSON::Arena::~Arena()
 {
-	mName = name;
-	mString = string;
-	mType = T_STRING;
+    release();
 }
 
-JSON::Value::Value(const std::string& name, const std::vector < Value >& array)
+std::pmr::memory_resource* JSON::Arena::resource()
 {
-	mName = name;
-	mArray = array;
-	mType = T_ARRAY;
+    return &mResource;
 }
 
-JSON::Value::Value(const std::string& name, bool rhs)
+void JSON::Arena::release()
+{
+    for (std::string* string : mStrings)
+        string->~basic_string();
+    
+    mStrings.clear();
+    mResource.release();
+}
+
+std::string* JSON::Arena::makeString(std::string&& rhs)
+{
+    std::string* string = make < std::string >(std::move(rhs));
+    
+    if (string->capacity() > std::string().capacity())
+        mStrings.push_back(string);
+    
+    return string;
+}
+
+template < typename T, typename... Args > T* JSON::makeNode(Args&&... args)
+{
+    static_assert(alignof(T) <= NODE_HEADER, "A node must be aligned after its header.");
+    char* memory = static_cast < char* >(::operator new(NODE_HEADER + sizeof(T)));
+    
+    try
+    {
+        T* node = new (memory + NODE_HEADER) T(std::forward < Args >(args)...);
+        new (memory) std::atomic < std::uint32_t >(1);
+        return node;
+    }
+    
+    catch(...)
+    {
+        ::operator delete(memory);
+        throw;
+    }
+}
+
+std::atomic < std::uint32_t >& JSON::owners(const void* node) noexcept
+{
+    return *reinterpret_cast < std::atomic < std::uint32_t >* >(const_cast < char* >(static_cast < const char* >(node)) - NODE_HEADER);
+}
+
+template < typename T > T* JSON::retainNode(T* node) noexcept
+{
+    owners(node).fetch_add(1, std::memory_order_relaxed);
+    return node;
+}
+
+template < typename T > void JSON::releaseNode(T* node) noexcept
+{
+    // The last owner must see every change made by the others before destroying the node.
+    if (owners(node).fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+    
+    char* memory = reinterpret_cast < char* >(node) - NODE_HEADER;
+    node->~T();
+    reinterpret_cast < std::atomic < std::uint32_t >* >(memory)->~atomic();
+    ::operator delete(memory);
+}
+
+template < typename T > void JSON::detachNode(T*& node)
+{
+    // The copy shares the children of the node until they are changed in turn.
+    if (owners(node).load(std::memory_order_acquire) > 1)
+    {
+        T* copy = makeNode < T >(*node);
+        releaseNode(node);
+        node = copy;
+    }
+}
+
+void JSON::Value::expose()
+{
+    // Nothing is shared once handed out: a copy made later shares the node again, the
+    // reference must be taken again to change this value only.
+    if (mFlags & F_PAYLOAD_BORROWED)
+        return;
+    
+    switch (mType)
+    {
+        case T_OBJECT: detachNode(mObject); break;
+        case T_STRING: detachNode(mString); break;
+        case T_ARRAY: detachNode(mArray); break;
+        default: break;
+    }
+}
+
+JSON::Value::Value(std::string_view name)
+: mName(nullptr)
+, mLength(0)
+, mNameLength(0)
+, mType(T_NULL)
+, mFlags(0)
+{
+    assignName(name);
+}
+
+JSON::Value::Value(std::string_view name, const JSON& object)
+: Value(name)
+{
+    mObject = makeNode < JSON >(object);
+    mType = T_OBJECT;
+}
+
+JSON::Value::Value(std::string_view name, JSON&& object)
+: Value(name)
+{
+    mObject = makeNode < JSON >(std::move(object));
+    mType = T_OBJECT;
+}
+
+JSON::Value::Value(std::string_view name, const JSON::Number& number)
+: Value(name)
+{
+    mNumber = number;
+    mType = T_NUMBER;
+}
+
+JSON::Value::Value(std::string_view name, std::int64_t number)
+: Value(name)
+{
+    mInteger = number;
+    mType = T_NUMBER;
+    mFlags |= F_INTEGER;
+}
+
+JSON::Value::Value(std::string_view name, std::uint64_t number)
+: Value(name)
+{
+    *this = number;
+}
+
+JSON::Value::Value(std::string_view name, const std::string& string)
+: Value(name)
+{
+    mString = makeNode < std::string >(string);
+    mType = T_STRING;
+}
+
+JSON::Value::Value(std::string_view name, std::string&& string)
+: Value(name)
+{
+    mString = makeNode < std::string >(std::move(string));
+    mType = T_STRING;
+}
+
+JSON::Value::Value(std::string_view name, const Array& array)
+: Value(name)
+{
+    mArray = makeNode < Array >(array);
+    mType = T_ARRAY;
+}
+
+JSON::Value::Value(std::string_view name, Array&& array)
+: Value(name)
+{
+    mArray = makeNode < Array >(std::move(array));
+    mType = T_ARRAY;
+}
+
+JSON::Value::Value(std::string_view name, bool rhs)
+: Value(name)
 {
-    mName = name;
+    mBoolean = rhs;
+    mType = T_BOOLEAN;
+}
+
+JSON::Value::Value(std::string_view name, JSON&& object, Arena& arena)
+: Value()
+{
+    assignName(name, arena);
+    assign(std::move(object), arena);
+}
+
+JSON::Value::Value(std::string_view name, const Number& number, Arena& arena)
+: Value()
+{
+    assignName(name, arena);
+    mNumber = number;
+    mType = T_NUMBER;
+}
+
+JSON::Value::Value(std::string_view name, std::string&& string, Arena& arena)
+: Value()
+{
+    assignName(name, arena);
+    assign(std::move(string), arena);
+}
+
+JSON::Value::Value(std::string_view name, Array&& array, Arena& arena)
+: Value()
+{
+    assignName(name, arena);
+    assign(std::move(array), arena);
+}
+
+JSON::Value::Value(std::string_view name, bool rhs, Arena& arena)
+: Value()
+{
+    assignName(name, arena);
     mBoolean = rhs;
     mType = T_BOOLEAN;
 }
 
 JSON::Value::Value(const JSON::Value& rhs)
+: Value()
 {
-	mName = rhs.mName;
-	mType = rhs.mType;
-	
-	if (rhs.mObject)
-	mObject.reset(new JSON(*rhs.mObject));
-	
-	mString = rhs.mString;
-	mNumber = rhs.mNumber;
-	mArray = rhs.mArray;
-    mBoolean = rhs.mBoolean;
+    // Interned names live as long as the program: share them.
+    if (rhs.mFlags & F_NAME_INTERNED)
+    {
+        mName = rhs.mName;
+        mNameLength = rhs.mNameLength;
+        mFlags |= F_NAME;
+    }
+    
+    else
+        assignName(rhs.name());
+    
+    // Objects, arrays and strings are shared until a copy changes them. Unshared ones view
+    // the content, and borrowed ones may not outlive their owner.
+    bool shared = !(rhs.mFlags & (F_PAYLOAD_BORROWED | F_PAYLOAD_UNSHARED));
+    
+    switch (rhs.mType)
+    {
+        case T_OBJECT: mObject = shared ? retainNode(rhs.mObject) : makeNode < JSON >(*rhs.mObject); break;
+        case T_NUMBER: mUnsigned = rhs.mUnsigned; mFlags |= rhs.mFlags & (F_INTEGER | F_UNSIGNED); break;
+        case T_STRING: mString = shared ? retainNode(rhs.mString) : makeNode < std::string >(rhs.toStringView()); break;
+        case T_ARRAY: mArray = shared ? retainNode(rhs.mArray) : makeNode < Array >(*rhs.mArray); break;
+        case T_BOOLEAN: mBoolean = rhs.mBoolean; break;
+        case T_NULL: break;
+    }
+    
+    mType = rhs.mType;
 }
 
-JSON::Value& JSON::Value::operator=(const JSON::Value& rhs)
+JSON::Value::Value(JSON::Value&& rhs) noexcept
+: mName(rhs.mName)
+, mLength(0)
+, mNameLength(rhs.mNameLength)
+, mType(T_NULL)
+, mFlags(rhs.mFlags & F_NAME)
+{
+    rhs.mName = nullptr;
+    rhs.mNameLength = 0;
+    rhs.mFlags &= ~F_NAME;
+    steal(rhs);
+}
+
+JSON::Value::~Value()
+{
+    clear();
+    releaseName();
+}
+
+void JSON::Value::clear() noexcept
+{
+    if (!(mFlags & F_PAYLOAD_BORROWED))
+    {
+        switch (mType)
+        {
+            case T_OBJECT: releaseNode(mObject); break;
+            case T_STRING: releaseNode(mString); break;
+            case T_ARRAY: releaseNode(mArray); break;
+            default: break;
+        }
+    }
+    
+    mType = T_NULL;
+    mFlags &= ~F_PAYLOAD;
+}
+
+void JSON::Value::steal(JSON::Value& rhs) noexcept
 {
-    mName = rhs.mName;
+    switch (rhs.mType)
+    {
+        case T_OBJECT: mObject = rhs.mObject; break;
+        case T_NUMBER: mUnsigned = rhs.mUnsigned; break;
+        case T_STRING: mString = rhs.mString; break;
+        case T_ARRAY: mArray = rhs.mArray; break;
+        case T_BOOLEAN: mBoolean = rhs.mBoolean; break;
+        case T_NULL: break;
+    }
+    
     mType = rhs.mType;
+    mLength = rhs.mLength;
+    mFlags |= rhs.mFlags & F_PAYLOAD;
+    rhs.mType = T_NULL;
+    rhs.mFlags &= ~F_PAYLOAD;
+}
+
+void JSON::Value::releaseName() noexcept
+{
+    if (mName && !(mFlags & F_NAME_BORROWED))
+        delete [] (mNameLength == LONG_NAME ? mName - sizeof(std::uint32_t) : mName);
+    
+    mName = nullptr;
+    mNameLength = 0;
+    mFlags &= ~F_NAME;
+}
+
+std::size_t JSON::Value::nameFootprint(std::size_t size) noexcept
+{
+    return size < LONG_NAME ? size : size + sizeof(std::uint32_t);
+}
+
+void JSON::Value::storeName(std::string_view name, char* buffer) noexcept
+{
+    if (name.size() < LONG_NAME)
+        mNameLength = static_cast < std::uint16_t >(name.size());
+    
+    else
+    {
+        std::uint32_t size = static_cast < std::uint32_t >(name.size());
+        std::memcpy(buffer, &size, sizeof(size));
+        buffer += sizeof(size);
+        mNameLength = LONG_NAME;
+    }
+    
+    std::memcpy(buffer, name.data(), name.size());
+    mName = buffer;
+}
+
+void JSON::Value::assignName(std::string_view name)
+{
+    releaseName();
+    
+    if (name.empty())
+        return;
+    
+    static_assert(JSON_INTERN_MAX < LONG_NAME, "Interned keys are stored as short names.");
+    std::string_view interned = intern(name);
+    
+    if (interned.empty())
+        storeName(name, new char[nameFootprint(name.size())]);
+    
+    else
+    {
+        mName = interned.data();
+        mNameLength = static_cast < std::uint16_t >(interned.size());
+        mFlags |= F_NAME;
+    }
+}
+
+void JSON::Value::assignName(std::string_view name, Arena& arena)
+{
+    releaseName();
+    
+    if (!name.empty())
+    {
+        std::size_t footprint = nameFootprint(name.size());
+        storeName(name, static_cast < char* >(arena.mResource.allocate(footprint, alignof(std::uint32_t))));
+        mFlags |= F_NAME_BORROWED;
+    }
+}
+
+void JSON::Value::borrowName(std::string_view name)
+{
+    if (name.size() >= LONG_NAME)
+        return assignName(name);
+    
+    releaseName();
+    mName = name.empty() ? nullptr : name.data();
+    mNameLength = static_cast < std::uint16_t >(name.size());
+    mFlags |= F_NAME_BORROWED;
+}
+
+void JSON::Value::borrowString(std::string_view string)
+{
+    clear();
+    
+    if (string.size() > UINT32_MAX)
+    {
+        mString = makeNode < std::string >(string);
+        mType = T_STRING;
+        return;
+    }
     
-    if (rhs.mObject)
-    mObject.reset(new JSON(*rhs.mObject));
+    mChars = string.data();
+    mLength = static_cast < std::uint32_t >(string.size());
+    mType = T_STRING;
+    mFlags |= F_PAYLOAD_BORROWED | F_STRING_VIEW;
+}
+
+void JSON::Value::assign(JSON&& object, Arena& arena)
+{
+    clear();
+    mObject = arena.make < JSON >(std::move(object));
+    mType = T_OBJECT;
+    mFlags |= F_PAYLOAD_BORROWED;
+}
+
+void JSON::Value::assign(std::string&& string, Arena& arena)
+{
+    clear();
+    mString = arena.makeString(std::move(string));
+    mType = T_STRING;
+    mFlags |= F_PAYLOAD_BORROWED;
+}
+
+void JSON::Value::assign(Array&& array, Arena& arena)
+{
+    clear();
+    mArray = arena.make < Array >(std::move(array), arena.resource());
+    mType = T_ARRAY;
+    mFlags |= F_PAYLOAD_BORROWED;
+}
+
+std::string& JSON::Value::materialize()
+{
+    if (mFlags & F_STRING_VIEW)
+    {
+        mString = makeNode < std::string >(mChars, mLength);
+        mFlags &= ~(F_PAYLOAD_BORROWED | F_STRING_VIEW);
+    }
     
-    mString = rhs.mString;
-    mNumber = rhs.mNumber;
-    mArray = rhs.mArray;
-    mBoolean = rhs.mBoolean;
+    else
+        expose();
+    
+    return *mString;
+}
+
+JSON::Value& JSON::Value::operator=(const JSON::Value& rhs)
+{
+    // Copy first: rhs may live inside the subtree we are about to replace.
+    if (this != &rhs)
+        *this = Value(rhs);
+    
+    return *this;
+}
+
+JSON::Value& JSON::Value::operator=(JSON::Value&& rhs) noexcept
+{
+    if (this == &rhs)
+        return *this;
+    
+    // Detach rhs first: it may live inside the subtree we are about to replace.
+    Value tmp(std::move(rhs));
+    
+    // The name stays: it is the key of this value in its object, which indexes it. Only
+    // construction and addValue() name values.
+    clear();
+    steal(tmp);
     
     return *this;
 }
@@ -130,51 +597,115 @@ bool JSON::Value::isNull() const
 JSON& JSON::Value::toObject() 
 {
 	JSON_THROW_IF(!isObject(), Exception("invalid toObject() type conversion."));
-	JSON_THROW_IF(!mObject, Exception("null object held."));
+	expose();
 	return *mObject;
 }
 
 const JSON& JSON::Value::toObject() const 
 {
 	JSON_THROW_IF(!isObject(), Exception("invalid toObject() type conversion."));
-	JSON_THROW_IF(!mObject, Exception("null object held."));
 	return *mObject;
 }
 
 JSON::Number& JSON::Value::toNumber()
 {
 	JSON_THROW_IF(!isNumber(), Exception("invalid toNumber() type conversion."));
+	
+	if (mFlags & (F_INTEGER | F_UNSIGNED))
+	{
+	    mNumber = toDouble();
+	    mFlags &= ~(F_INTEGER | F_UNSIGNED);
+	}
+	
 	return mNumber;
 }
 
-const JSON::Number& JSON::Value::toNumber() const
+JSON::Number JSON::Value::toNumber() const
 {
 	JSON_THROW_IF(!isNumber(), Exception("invalid toNumber() type conversion."));
-	return mNumber;
+	return toDouble();
+}
+
+bool JSON::Value::isInteger() const
+{
+    return mType == T_NUMBER && (mFlags & (F_INTEGER | F_UNSIGNED));
+}
+
+std::int64_t JSON::Value::toInt64() const
+{
+    JSON_THROW_IF(!isNumber(), Exception("invalid toInt64() type conversion."));
+    
+    if (mFlags & F_INTEGER)
+        return mInteger;
+    
+    JSON_THROW_IF((mFlags & F_UNSIGNED) || !(mNumber >= -0x1p63 && mNumber < 0x1p63),
+                  Exception("toInt64(): number out of range."));
+    
+    return static_cast < std::int64_t >(mNumber);
+}
+
+std::uint64_t JSON::Value::toUInt64() const
+{
+    JSON_THROW_IF(!isNumber(), Exception("invalid toUInt64() type conversion."));
+    
+    if (mFlags & F_UNSIGNED)
+        return mUnsigned;
+    
+    if (mFlags & F_INTEGER)
+    {
+        JSON_THROW_IF(mInteger < 0, Exception("toUInt64(): number out of range."));
+        return static_cast < std::uint64_t >(mInteger);
+    }
+    
+    JSON_THROW_IF(!(mNumber > -1.0 && mNumber < 0x1p64), Exception("toUInt64(): number out of range."));
+    return static_cast < std::uint64_t >(mNumber);
+}
+
+double JSON::Value::toDouble() const
+{
+    JSON_THROW_IF(!isNumber(), Exception("invalid toDouble() type conversion."));
+    
+    if (mFlags & F_INTEGER)
+        return static_cast < double >(mInteger);
+    
+    if (mFlags & F_UNSIGNED)
+        return static_cast < double >(mUnsigned);
+    
+    return mNumber;
 }
 
 std::string& JSON::Value::toString() 
 {
 	JSON_THROW_IF(!isString(), Exception("invalid toString() type conversion."));
-	return mString;
+	return materialize();
 }
 
-const std::string& JSON::Value::toString() const
+std::string JSON::Value::toString() const
 {
-	JSON_THROW_IF(!isString(), Exception("invalid toString() type conversion."));
-	return mString;
+	return std::string(toStringView());
+}
+
+std::string_view JSON::Value::toStringView() const
+{
+    JSON_THROW_IF(!isString(), Exception("invalid toString() type conversion."));
+    
+    if (mFlags & F_STRING_VIEW)
+        return std::string_view(mChars, mLength);
+    
+    return *mString;
 }
 
 JSON::Array& JSON::Value::toArray() 
 {
 	JSON_THROW_IF(!isArray(), Exception("invalid toArray() type conversion."));
-	return mArray;
+	expose();
+	return *mArray;
 }
 
 const JSON::Array& JSON::Value::toArray() const
 {
 	JSON_THROW_IF(!isArray(), Exception("invalid toArray() type conversion."));
-	return mArray;
+	return *mArray;
 }
 
 bool& JSON::Value::toBoolean()
@@ -189,131 +720,158 @@ const bool& JSON::Value::toBoolean() const
     return mBoolean;
 }
 
-const std::string& JSON::Value::name() const 
+std::string_view JSON::Value::name() const 
 {
-	return mName;
+    if (mNameLength != LONG_NAME)
+        return std::string_view(mName, mNameLength);
+    
+    std::uint32_t size;
+    std::memcpy(&size, mName - sizeof(size), sizeof(size));
+    return std::string_view(mName, size);
 }
 
 JSON::Value& JSON::Value::at(const std::size_t& index) 
 {
 	JSON_THROW_IF(!isArray(), Exception("invalid Array type conversion."));
-	return mArray.at(index);
+	expose();
+	return mArray->at(index);
 }
 
 const JSON::Value& JSON::Value::at(const std::size_t& index) const
 {
 	JSON_THROW_IF(!isArray(), Exception("invalid Array type conversion."));
-	return mArray.at(index);
+	return mArray->at(index);
 }
 
-JSON::Value& JSON::Value::operator[](const std::string& name)
+JSON::Value& JSON::Value::operator[](std::string_view name)
 {
-    JSON_THROW_IF(!isObject()||!mObject, Exception("invalid object conversion"));
+    JSON_THROW_IF(!isObject(), Exception("invalid object conversion"));
+    expose();
     return (*mObject)[name];
 }
 
-const JSON::Value& JSON::Value::operator[](const std::string& name) const
+const JSON::Value& JSON::Value::operator[](std::string_view name) const
 {
-    JSON_THROW_IF(!isObject()||!mObject, Exception("invalid object conversion"));
+    JSON_THROW_IF(!isObject(), Exception("invalid object conversion"));
     return (*mObject)[name];
 }
 
 std::string JSON::Value::str(unsigned level, bool printName) const
 {
-    std::string tabulates;
-    for (unsigned i = 0; i < level; ++i)
-        tabulates += "\t";
-    
-    std::string result;
-    std::stringstream stream(result);
+    Writer writer(Writer::L_PRETTY, "\t", level);
     
-    if(printName)
-    stream << tabulates << "\"" << mName << "\"" << ":";
+    if (printName)
+        writer.write(*this);
     else
-    stream << tabulates;
+        writer.writePayload(*this);
     
-    if (isObject())
-    {
-        stream << std::endl;
-        stream << mObject->str(level);
-    }
-    
-    else if (isArray())
-    {
-        stream << " [" << std::endl;
-        
-        for (unsigned i = 0; i < mArray.size(); ++i)
-        {
-            stream << mArray.at(i).str(level + 1, false);
-            
-            if (i + 1 < mArray.size())
-                stream << ",";
-            
-            stream << std::endl;
-        }
-        
-        stream << tabulates << "]";
-    }
+    return std::string(writer.content());
+}
+
+JSON::Value& JSON::Value::operator=(const std::string &rhs)
+{
+    // Only a string no copy shares is changed in place.
+    if (isString() && !(mFlags & F_PAYLOAD_BORROWED) && owners(mString).load(std::memory_order_acquire) == 1)
+        *mString = rhs;
     
-    else if (isNumber())
+    else
     {
-        stream << " " << mNumber;
+        // Build the payload first: rhs may live inside the one we replace.
+        std::string* string = makeNode < std::string >(rhs);
+        clear();
+        mString = string;
+        mType = T_STRING;
     }
     
-    else if (isString())
-    {
-        stream << " \"" << mString << "\"";
-    }
+    return *this;
+}
+
+JSON::Value& JSON::Value::operator=(std::string&& rhs)
+{
+    if (isString() && !(mFlags & F_PAYLOAD_BORROWED) && owners(mString).load(std::memory_order_acquire) == 1)
+        *mString = std::move(rhs);
     
-    else if (isBoolean())
+    else
     {
-        if (mBoolean)
-            stream << " true";
-        else
-            stream << " false";
+        std::string* string = makeNode < std::string >(std::move(rhs));
+        clear();
+        mString = string;
+        mType = T_STRING;
     }
     
-    return stream.str();
+    return *this;
 }
 
-JSON::Value& JSON::Value::operator=(const std::string &rhs)
+JSON::Value& JSON::Value::operator=(const JSON::Number& rhs)
 {
-    if (isObject())
-        mObject.reset();
-    mString = rhs;
-    mType = T_STRING;
+    Number number = rhs;
+    clear();
+    mNumber = number;
+    mType = T_NUMBER;
     return *this;
 }
 
-JSON::Value& JSON::Value::operator=(const JSON::Number& rhs)
+JSON::Value& JSON::Value::operator=(std::int64_t rhs)
 {
-    if (isObject())
-        mObject.reset();
-    mNumber = rhs;
+    clear();
+    mInteger = rhs;
+    mType = T_NUMBER;
+    mFlags |= F_INTEGER;
+    return *this;
+}
+
+JSON::Value& JSON::Value::operator=(std::uint64_t rhs)
+{
+    // Only integers above the signed range are flagged unsigned.
+    if (rhs <= static_cast < std::uint64_t >(INT64_MAX))
+        return *this = static_cast < std::int64_t >(rhs);
+    
+    clear();
+    mUnsigned = rhs;
     mType = T_NUMBER;
+    mFlags |= F_UNSIGNED;
     return *this;
 }
 
 JSON::Value& JSON::Value::operator=(const JSON::Array& rhs)
 {
-    if (isObject())
-        mObject.reset();
-    mArray = rhs;
+    Array* array = makeNode < Array >(rhs);
+    clear();
+    mArray = array;
+    mType = T_ARRAY;
+    return *this;
+}
+
+JSON::Value& JSON::Value::operator=(JSON::Array&& rhs)
+{
+    Array* array = makeNode < Array >(std::move(rhs));
+    clear();
+    mArray = array;
     mType = T_ARRAY;
     return *this;
 }
 
 JSON::Value& JSON::Value::operator=(const JSON& rhs)
 {
-    mObject.reset(new JSON(rhs));
+    JSON* object = makeNode < JSON >(rhs);
+    clear();
+    mObject = object;
+    mType = T_OBJECT;
+    return *this;
+}
+
+JSON::Value& JSON::Value::operator=(JSON&& rhs)
+{
+    JSON* object = makeNode < JSON >(std::move(rhs));
+    clear();
+    mObject = object;
     mType = T_OBJECT;
     return *this;
 }
 
 JSON::Value& JSON::Value::operator=(bool rhs)
 {
-    if (isObject())
-        mObject.reset();
+    clear();
     mBoolean = rhs;
     mType = T_BOOLEAN;
     return *this;
@@ -334,14 +892,14 @@ JSON::Value::operator JSON::Number()
     return toNumber();
 }
 
-JSON::Value::operator const JSON::Number() const
+JSON::Value::operator JSON::Number() const
 {
     return toNumber();
 }
 
 JSON::Value::operator JSON::Array()
 {
-    return toArray();
+    return std::as_const(*this).toArray();
 }
 
 JSON::Value::operator const JSON::Array() const
@@ -351,7 +909,7 @@ JSON::Value::operator const JSON::Array() const
 
 JSON::Value::operator JSON()
 {
-    return toObject();
+    return std::as_const(*this).toObject();
 }
 
 JSON::Value::operator const JSON() const
@@ -369,31 +927,289 @@ JSON::Value::operator const bool() const
     return toBoolean();
 }
 
-JSON::Value& JSON::value(const std::string& name) 
+JSON::Members::Members(std::pmr::memory_resource* resource)
+: values(resource)
+, index(resource)
+{
+    
+}
+
+JSON::Members::Members(const Members& rhs)
+: values(rhs.values)
+, index(rhs.index)
+{
+    
+}
+
+JSON::JSON(JSON::Arena& arena)
+: mMembers(arena.make < Members >(arena.resource()))
+{
+    mMembers->borrowed = true;
+}
+
+JSON::JSON(const JSON& rhs)
+{
+    // Members viewing the content or living in an arena are copied on the heap.
+    if (rhs.mMembers)
+        mMembers = rhs.mMembers->unshared || rhs.mMembers->borrowed ? makeNode < Members >(*rhs.mMembers) : retainNode(rhs.mMembers);
+}
+
+JSON::JSON(JSON&& rhs) noexcept
+: mMembers(rhs.mMembers)
+{
+    rhs.mMembers = nullptr;
+}
+
+JSON::~JSON()
+{
+    // The arena frees borrowed members, whose values may still need to free theirs.
+    if (mMembers && mMembers->borrowed)
+        mMembers->~Members();
+    
+    else if (mMembers)
+        releaseNode(mMembers);
+}
+
+JSON& JSON::operator=(const JSON& rhs)
 {
-	auto iter = std::find_if(mValues.begin(), mValues.end(), [name](auto& rhs){
-		return rhs.name() == name;
-	});
+    if (this != &rhs)
+        *this = JSON(rhs);
+    
+    return *this;
+}
+
+JSON& JSON::operator=(JSON&& rhs) noexcept
+{
+    if (this == &rhs)
+        return *this;
+    
+    // Released last: rhs may live inside the members we replace.
+    JSON previous(std::move(*this));
+    mMembers = rhs.mMembers;
+    rhs.mMembers = nullptr;
+    return *this;
+}
+
+const JSON::Array& JSON::values() const noexcept
+{
+    static const Array empty;
+    return mMembers ? mMembers->values : empty;
+}
+
+JSON::Members& JSON::members()
+{
+    if (!mMembers)
+        mMembers = makeNode < Members >();
+    
+    else if (!mMembers->borrowed)
+        detachNode(mMembers);
+    
+    return *mMembers;
+}
+
+JSON::JSON(JSON::Array values)
+{
+    for (auto& value : values)
+        addValue(std::move(value));
+}
+
+static std::size_t hashName(std::string_view name)
+{
+    return std::hash < std::string_view >()(name);
+}
+
+//! @brief Compares two names, by address first since most are interned.
+static bool sameName(std::string_view candidate, std::string_view name)
+{
+    return candidate.data() == name.data() ? candidate.size() == name.size() : candidate == name;
+}
+
+namespace
+{
+    //! @brief The pool behind JSON::intern(). It is split in shards, each with its own lock,
+    //! so that threads parsing different documents seldom wait for each other.
+    class KeyPool
+    {
+        struct Shard
+        {
+            std::mutex mutex;
+            std::unordered_set < std::string_view > keys;
+            std::vector < std::unique_ptr < char[] > > blocks;
+            std::size_t used = 0;
+        };
+        
+        static constexpr std::size_t SHARDS = 16;
+        static constexpr std::size_t BLOCK = 4096;
+        
+        Shard mShards[SHARDS];
+        std::atomic < std::size_t > mCount{ 0 };
+        
+    public:
+        std::string_view intern(std::string_view key, std::size_t hash)
+        {
+            Shard& shard = mShards[(hash >> 8) % SHARDS];
+            std::lock_guard < std::mutex > lock(shard.mutex);
+            auto it = shard.keys.find(key);
+            
+            if (it != shard.keys.end())
+                return *it;
+            
+            if (mCount.fetch_add(1, std::memory_order_relaxed) >= JSON_INTERN_LIMIT)
+            {
+                mCount.fetch_sub(1, std::memory_order_relaxed);
+                return std::string_view();
+            }
+            
+            if (shard.blocks.empty() || shard.used + key.size() > BLOCK)
+            {
+                shard.blocks.emplace_back(new char[BLOCK]);
+                shard.used = 0;
+            }
+            
+            char* copy = shard.blocks.back().get() + shard.used;
+            std::memcpy(copy, key.data(), key.size());
+            shard.used += key.size();
+            
+            return *shard.keys.emplace(copy, key.size()).first;
+        }
+    };
+    
+    // Never destroyed: names may be released by static destructors running after it.
+    KeyPool& keyPool()
+    {
+        static KeyPool* pool = new KeyPool();
+        return *pool;
+    }
+}
+
+std::string_view JSON::intern(std::string_view key)
+{
+    static_assert(JSON_INTERN_MAX <= 4096, "Interned keys must fit in a block of the pool.");
+    
+    if (key.empty() || key.size() > JSON_INTERN_MAX)
+        return std::string_view();
+    
+    // Keys seen recently by this thread are found without taking a lock.
+    thread_local std::string_view recent[256];
+    
+    std::size_t hash = hashName(key);
+    std::string_view& cached = recent[hash & 255];
+    
+    if (cached == key)
+        return cached;
+    
+    std::string_view interned = keyPool().intern(key, hash);
+    
+    if (!interned.empty())
+        cached = interned;
+    
+    return interned;
+}
+
+std::size_t JSON::find(std::string_view name) const
+{
+    if (!mMembers)
+        return 0;
+    
+    const Array& values = mMembers->values;
+    const std::pmr::vector < std::uint32_t >& index = mMembers->index;
+    
+    if (index.empty())
+    {
+        for (std::size_t i = 0; i < values.size(); ++i)
+            if (sameName(values[i].name(), name))
+                return i;
+        
+        return values.size();
+    }
+    
+    std::size_t mask = index.size() - 1;
+    
+    for (std::size_t slot = hashName(name) & mask; index[slot]; slot = (slot + 1) & mask)
+    {
+        if (sameName(values[index[slot] - 1].name(), name))
+            return index[slot] - 1;
+    }
+    
+    return values.size();
+}
+
+JSON::Value& JSON::insert(JSON::Value&& rhs)
+{
+    Members& members = this->members();
+    members.values.push_back(std::move(rhs));
+    
+    if (members.index.empty())
+    {
+        if (members.values.size() > JSON_INDEX_THRESHOLD)
+            reindex();
+    }
+    
+    else if (members.values.size() * 2 > members.index.size())
+        reindex();
+    
+    else
+    {
+        std::size_t mask = members.index.size() - 1;
+        std::size_t slot = hashName(members.values.back().name()) & mask;
+        
+        while (members.index[slot])
+            slot = (slot + 1) & mask;
+        
+        members.index[slot] = static_cast < std::uint32_t >(members.values.size());
+    }
+    
+    return members.values.back();
+}
+
+void JSON::reindex()
+{
+    Members& members = this->members();
+    std::size_t capacity = 2 * JSON_INDEX_THRESHOLD;
+    
+    while (capacity < members.values.size() * 4)
+        capacity *= 2;
+    
+    members.index.assign(capacity, 0);
+    std::size_t mask = capacity - 1;
+    
+    for (std::size_t i = 0; i < members.values.size(); ++i)
+    {
+        std::size_t slot = hashName(members.values[i].name()) & mask;
+        
+        while (members.index[slot])
+            slot = (slot + 1) & mask;
+        
+        members.index[slot] = static_cast < std::uint32_t >(i + 1);
+    }
+}
+
+JSON::Value& JSON::value(std::string_view name)
+{
+	std::size_t pos = find(name);
 	
-	if (iter == mValues.end())
-	return NullValue;
+	// Each thread has its own null, so writes to it neither race nor show in later lookups.
+	if (pos == values().size())
+	{
+	    thread_local Value missing(nullptr);
+	    missing = Value(nullptr);
+	    return missing;
+	}
 	
-	return *iter;
+	return members().values[pos];
 }
 
-const JSON::Value& JSON::value(const std::string& name) const
+const JSON::Value& JSON::value(std::string_view name) const
 {
-	auto iter = std::find_if(mValues.begin(), mValues.end(), [name](auto& rhs){
-		return rhs.name() == name;
-	});
+	std::size_t pos = find(name);
 	
-	if (iter == mValues.end())
+	if (pos == values().size())
 	return NullValue;
 	
-	return *iter;
+	return values()[pos];
 }
 
-const std::string& JSON::valueOf(const std::string& name, const std::string& def) const
+std::string JSON::valueOf(const std::string& name, const std::string& def) const
 {
 	const Value& result = value(name);
 	
@@ -403,7 +1219,7 @@ const std::string& JSON::valueOf(const std::string& name, const std::string& def
 	return result.toString();
 }
 
-const JSON::Number& JSON::valueOf(const std::string& name, const JSON::Number& def) const
+JSON::Number JSON::valueOf(const std::string& name, const JSON::Number& def) const
 {
 	const Value& val = value(name);
 	
@@ -433,97 +1249,83 @@ const JSON::Array& JSON::valueOf(const std::string& name, const JSON::Array& def
 	return val.toArray();
 }
 
-JSON::Value& JSON::operator[](const std::string& name)
+JSON::Value& JSON::operator[](std::string_view name)
 {
-	Value& result = value(name);
+    std::size_t pos = find(name);
     
-    if (result.isNull())
-    {
-        addValue(Value(name));
-        return value(name);
-    }
+    if (pos == values().size())
+        return insert(Value(name));
     
-    return result;
+    return members().values[pos];
 }
 
-const JSON::Value& JSON::operator[](const std::string& name) const
+const JSON::Value& JSON::operator[](std::string_view name) const
 {
 	return value(name);
 }
 
 JSON::Array::iterator JSON::begin() 
 {
-	return mValues.begin();
+	// An empty object has no values to change: it stays without members.
+	return mMembers ? members().values.begin() : Array::iterator();
 }
 
 JSON::Array::const_iterator JSON::begin() const
 {
-	return mValues.begin();
+	return values().begin();
 }
 
 JSON::Array::const_iterator JSON::cbegin() const
 {
-	return mValues.cbegin();
+	return values().cbegin();
 }
 
 JSON::Array::iterator JSON::end() 
 {
-	return mValues.end();
+	return mMembers ? members().values.end() : Array::iterator();
 }
 
 JSON::Array::const_iterator JSON::end() const
 {
-	return mValues.end();
+	return values().end();
 }
 
 JSON::Array::const_iterator JSON::cend() const
 {
-	return mValues.cend();
+	return values().cend();
 }
 
 void JSON::addValue(const JSON::Value& rhs) 
 {
-	Value& check = value(rhs.name());
-	
-	if (!check.isNull())
-	check = rhs;
-	
-	else 
-	mValues.push_back(rhs);
+	addValue(Value(rhs));
 }
 
-std::string JSON::str(unsigned level) const
+void JSON::addValue(JSON::Value&& rhs)
 {
-    std::string tabulates;
-    for (unsigned i = 0; i < level; ++i)
-        tabulates += "\t";
+    std::size_t pos = find(rhs.name());
     
-    std::string result;
-    std::stringstream stream(result);
-    stream << tabulates << "{" << std::endl;
+    if (pos != values().size())
+        members().values[pos] = std::move(rhs);
     
-    for (int i = 0; i < mValues.size(); ++i)
-    {
-        stream << mValues.at(i).str(level + 1);
-        
-        if (i + 1 < mValues.size())
-            stream << ",";
-        
-        stream << std::endl;
-    }
-    
-    stream << tabulates << "}";
-    return stream.str();
+    else
+        insert(std::move(rhs));
+}
+
+std::string JSON::str(unsigned level) const
+{
+    Writer writer(Writer::L_PRETTY, "\t", level);
+    writer.write(*this);
+    return std::string(writer.content());
 }
 
 std::ostream& operator << (std::ostream& out, const JSON& obj)
 {
-    out << obj.str();
+    JSON::Writer(out).write(obj);
     return out;
 }
 
 std::ostream& operator << (std::ostream& out, const JSON::Value& value)
 {
-    out << value.str();
+    JSON::Writer(out).write(value);
     return out;
 }
@@ -8,10 +8,58 @@
 #include <vector>
 #include <iostream>
 #include <map>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <limits>
+#include <utility>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <new>
 
 #define JSON_THROW(EXC) throw EXC
 #define JSON_THROW_IF(CND, EXC) if((CND)) JSON_THROW(EXC)
 #define JSON_MAX_BUFFER 4096
+#define JSON_INDEX_THRESHOLD 8
+#define JSON_ARENA_BLOCK 65536
+#define JSON_WRITER_BLOCK 65536
+#define JSON_LINES_CHUNK 1048576
+#define JSON_ARRAY_PIECE 262144
+#define JSON_INTERN_MAX 64
+#define JSON_INTERN_LIMIT 1048576
+#define JSON_SNAPSHOT_SLOTS 16
+#define JSON_WATCH_DEBOUNCE 100
+
+//! @brief Declares the fields of a structure, which JSON::Writer::serialize() then writes
+//! as an object and JSON::parseInto() reads from one, each field being a member of the
+//! same name:
+//! @code
+//! struct Point { int x; int y; JSON_FIELDS(x, y) };
+//! @endcode
+#define JSON_FIELDS(...) \
+    typedef void JSONFields; \
+    static const JSON::FieldNames& fieldNames() { \
+        static const JSON::FieldNames names(#__VA_ARGS__); \
+        return names; \
+    } \
+    template < typename Visitor > void visitFields(Visitor&& visitor) const { \
+        JSON::visitFields(visitor, fieldNames(), __VA_ARGS__); \
+    } \
+    template < typename Visitor > void visitField(std::size_t index, Visitor&& visitor) { \
+        JSON::visitField(index, visitor, __VA_ARGS__); \
+    }
+
+//! @brief Set to 0 to scan with the portable byte-per-byte kernels only.
+#ifndef JSON_SIMD
+#define JSON_SIMD 1
+#endif
 
 //! @brief The Main JSON Object class.
 //! This class has multiple purpose: being the Object JSON structure, represents
@@ -19,8 +67,9 @@
 class JSON 
 {
 public:
-	//! @brief The Number representation. 
-	typedef float Number;
+	//! @brief The Number representation.
+	//! Integers are stored exactly as 64 bits integers instead, see Value::isInteger().
+	typedef double Number;
 	
 	//! @brief An Exception for all JSON functions.
 	class Exception : public std::exception 
@@ -34,49 +83,213 @@ public:
 		const char* what() const noexcept;
 	};
 	
+	class Arena;
+	class Value;
+	class Writer;
+	class BinaryWriter;
+	
+	//! @brief Selects how a loaded document stores its keys and strings.
+	enum Storage
+	{
+		//! @brief Keys and strings are copied into the document.
+		S_COPY,
+		//! @brief Keys and strings without escapes are views into the loaded content, which
+		//! must outlive the document. Copying the document gives an independent one.
+		S_IN_SITU
+	};
+	
+	//! @brief Selects the binary format of a BinaryWriter or a BinaryReader.
+	enum BinaryFormat
+	{
+		//! @brief CBOR, RFC 8949.
+		B_CBOR,
+		//! @brief MessagePack.
+		B_MESSAGEPACK
+	};
+	
+	//! @brief The Array representation.
+	//! Arrays allocate through a memory resource, the heap unless they belong to an Arena.
+	typedef std::pmr::vector < Value > Array;
+	
+private:
+	//! @brief Reads a texted JSON, see JSONReader.h.
+	class Reader;
+	
+	//! @brief Scans whitespaces and strings with vector instructions, see JSONScanner.h.
+	class Scanner;
+	
+	//! @brief Tells whether T declares its fields with JSON_FIELDS().
+	template < typename T, typename = void > struct HasFields : std::false_type {};
+	template < typename T > struct HasFields < T, std::void_t < typename T::JSONFields > > : std::true_type {};
+	
+	//! @brief Tells whether T has a toJSON(JSON&) function.
+	template < typename T, typename = void > struct HasToJSON : std::false_type {};
+	template < typename T > struct HasToJSON < T, std::void_t < decltype(std::declval < const T& >().toJSON(std::declval < JSON& >())) > >
+	: std::true_type {};
+	
+	//! @brief Tells whether T has a fromJSON(const JSON&) function.
+	template < typename T, typename = void > struct HasFromJSON : std::false_type {};
+	template < typename T > struct HasFromJSON < T, std::void_t < decltype(std::declval < T& >().fromJSON(std::declval < const JSON& >())) > >
+	: std::true_type {};
+	
+public:
 	//! @brief A JSON Value is a pair of a name and: an object, a number or a string.
+	//! Only the payload selected by the type is stored; objects, strings and arrays
+	//! live out of line, so a Value is three words whatever it holds.
+	//! Copies share objects, strings and arrays, and a non-const accessor gives the value
+	//! its own before handing out a reference. Get such a reference again after copying the
+	//! value or an object holding it: a change through the old one shows in the copy.
 	class Value 
 	{
-		//! @brief Holds the name of this value.
-		std::string mName;
+		//! @brief Holds the characters of the name of this value, or null if the name is empty.
+		const char* mName;
 		
-		//! @brief Holds an object if this is an object.
-		std::unique_ptr < JSON > mObject;
+		union
+		{
+			//! @brief Holds an object if T_OBJECT.
+			JSON* mObject;
+			
+			//! @brief Holds a number if T_NUMBER and neither F_INTEGER nor F_UNSIGNED.
+			Number mNumber;
+			
+			//! @brief Holds a number if T_NUMBER and F_INTEGER.
+			std::int64_t mInteger;
+			
+			//! @brief Holds a number if T_NUMBER and F_UNSIGNED, above the range of mInteger.
+			std::uint64_t mUnsigned;
+			
+			//! @brief Holds a string if T_STRING.
+			std::string* mString;
+			
+			//! @brief Holds the characters of a string if T_STRING and F_STRING_VIEW.
+			const char* mChars;
+			
+			//! @brief Holds an array of values if T_ARRAY.
+			Array* mArray;
+			
+			//! @brief Holds the bool value, true or false, if T_BOOLEAN.
+			bool mBoolean;
+		};
 		
-		//! @brief Holds a number if this is a number.
-		Number mNumber;
+		//! @brief Holds the length of mChars if F_STRING_VIEW.
+		std::uint32_t mLength;
 		
-		//! @brief Holds a string if this is a string.
-		std::string mString;
+		//! @brief Holds the length of the name, or LONG_NAME if it is stored in front of mName.
+		std::uint16_t mNameLength;
 		
-		//! @brief Holds an array of values if this is an array.
-		std::vector < Value > mArray;
+		//! @brief Names this long or longer store their length in front of their characters.
+		static constexpr std::uint16_t LONG_NAME = 0xFFFF;
 		
-		enum Type { T_OBJECT, T_NUMBER, T_STRING, T_ARRAY, T_BOOLEAN, T_NULL };
+		enum Type : std::uint8_t { T_OBJECT, T_NUMBER, T_STRING, T_ARRAY, T_BOOLEAN, T_NULL };
 		//! @brief Holds the type of this value.
 		Type mType;
-        
-        //! @brief Holds the bool value, true or false, if T_BOOLEAN.
-        bool mBoolean;
+		
+		//! @brief Flags telling which parts of this value are owned by someone else, an
+		//! Arena or the loaded content, and must not be freed with it, and how numbers are stored.
+		//! F_NAME_INTERNED names are borrowed from the pool of JSON::intern(), and copies share them.
+		//! Copies copy F_PAYLOAD_UNSHARED objects and arrays instead of sharing them: their values
+		//! view the loaded content.
+		enum Flags : std::uint8_t { F_NAME_BORROWED = 1, F_PAYLOAD_BORROWED = 2, F_STRING_VIEW = 4,
+		                            F_INTEGER = 8, F_UNSIGNED = 16, F_NAME_INTERNED = 32, F_PAYLOAD_UNSHARED = 64 };
+		//! @brief The flags describing the name, which follow it when it moves.
+		static constexpr std::uint8_t F_NAME = F_NAME_BORROWED | F_NAME_INTERNED;
+		//! @brief The flags describing the payload, which follow it when it moves.
+		static constexpr std::uint8_t F_PAYLOAD = F_PAYLOAD_BORROWED | F_STRING_VIEW | F_INTEGER | F_UNSIGNED |
+		                                          F_PAYLOAD_UNSHARED;
+		//! @brief Holds the ownership flags.
+		std::uint8_t mFlags;
+		
+		friend class Reader;
+		friend class Writer;
+		friend class BinaryWriter;
+		
+		//! @brief Destroys the active payload and leaves this value null.
+		void clear() noexcept;
+		//! @brief Takes the payload of rhs and leaves rhs null.
+		void steal(Value& rhs) noexcept;
+		//! @brief Destroys the name if this value owns it.
+		void releaseName() noexcept;
+		
+		//! @brief Gives this value its own object, array or string if a copy shares it, before
+		//! a non-const accessor hands it out.
+		void expose();
+		
+		//! @brief Writes the name into buffer and points to it.
+		//! The buffer holds nameFootprint(name.size()) characters.
+		void storeName(std::string_view name, char* buffer) noexcept;
+		//! @brief Returns the number of characters needed to store a name.
+		static std::size_t nameFootprint(std::size_t size) noexcept;
+		
+		//! @brief Points to the name in the pool of interned keys, or copies it on the heap if it
+		//! cannot be interned.
+		void assignName(std::string_view name);
+		//! @brief Copies the name in the arena.
+		void assignName(std::string_view name, Arena& arena);
+		//! @brief Points to the name, which must outlive this value.
+		void borrowName(std::string_view name);
+		//! @brief Points to the string, which must outlive this value.
+		void borrowString(std::string_view string);
+		
+		//! @brief Places the object in the arena.
+		void assign(JSON&& object, Arena& arena);
+		//! @brief Places the string in the arena.
+		void assign(std::string&& string, Arena& arena);
+		//! @brief Places the array in the arena.
+		void assign(Array&& array, Arena& arena);
+		
+		//! @brief Copies a viewed string into this value, so it can be handed out as a std::string.
+		std::string& materialize();
 		
 	public:
 		//! @brief Constructs a Value with a null type.
-		Value(const std::string& name = std::string());
+		Value(std::string_view name = std::string_view());
+		//! @brief Constructs a null Value without a name, at compile time.
+		explicit constexpr Value(std::nullptr_t) noexcept
+		: mName(nullptr), mUnsigned(0), mLength(0), mNameLength(0), mType(T_NULL), mFlags(0) { }
 		//! @brief Constructs a Value from an object.
-		Value(const std::string& name, const JSON& object);
+		Value(std::string_view name, const JSON& object);
+		//! @brief Constructs a Value from an object, taking its values.
+		Value(std::string_view name, JSON&& object);
 		//! @brief Constructs a Value from a number.
-		Value(const std::string& name, const Number& number);
+		Value(std::string_view name, const Number& number);
+		//! @brief Constructs a Value from an integer, stored exactly.
+		Value(std::string_view name, std::int64_t number);
+		//! @brief Constructs a Value from an unsigned integer, stored exactly.
+		Value(std::string_view name, std::uint64_t number);
 		//! @brief Constructs a Value from a string.
-		Value(const std::string& name, const std::string& string);
+		Value(std::string_view name, const std::string& string);
+		//! @brief Constructs a Value from a string, taking its buffer.
+		Value(std::string_view name, std::string&& string);
 		//! @brief Constructs a Value from an array.
-		Value(const std::string& name, const std::vector < Value >& array);
+		Value(std::string_view name, const Array& array);
+		//! @brief Constructs a Value from an array, taking its elements.
+		Value(std::string_view name, Array&& array);
         //! @brief Constructs a Value from a boolean.
-        Value(const std::string& name, bool rhs);
+        Value(std::string_view name, bool rhs);
+		
+		//! @brief Constructs a Value whose name and object live in the arena.
+		//! Such a value never frees anything: the arena releases it, and must outlive it.
+		Value(std::string_view name, JSON&& object, Arena& arena);
+		//! @brief Constructs a Value whose name lives in the arena.
+		Value(std::string_view name, const Number& number, Arena& arena);
+		//! @brief Constructs a Value whose name and string live in the arena.
+		Value(std::string_view name, std::string&& string, Arena& arena);
+		//! @brief Constructs a Value whose name and array live in the arena.
+		Value(std::string_view name, Array&& array, Arena& arena);
+		//! @brief Constructs a Value whose name lives in the arena.
+		Value(std::string_view name, bool rhs, Arena& arena);
 		//! @brief Copies the value.
 		Value(const Value& rhs);
+		//! @brief Moves the value. The moved-from value is left null.
+		Value(Value&& rhs) noexcept;
+		//! @brief Destroys the value and its payload.
+		~Value();
         
-        //! @brief Copies the value.
+        //! @brief Copies the payload of the value, keeping the name of this one.
         Value& operator = (const Value& rhs);
+        //! @brief Moves the payload of the value, keeping the name of this one. The moved-from
+        //! value is left null.
+        Value& operator = (Value&& rhs) noexcept;
 		
 		//! @brief Returns true if this value is an object.
 		bool isObject() const;
@@ -99,25 +312,41 @@ public:
 		const JSON& toObject() const;
 		
 		//! @brief Returns a reference to the number, or throws an exception 
-		//! if this value doesn't hold a number.
+		//! if this value doesn't hold a number. An integer is converted to a Number first.
 		Number& toNumber();
-		//! @brief Returns a reference to the number, or throws an exception 
+		//! @brief Returns the number, or throws an exception 
 		//! if this value doesn't hold a number.
-		const Number& toNumber() const;
+		Number toNumber() const;
+		
+		//! @brief Returns true if this value holds an integer, stored exactly.
+		bool isInteger() const;
+		//! @brief Returns the number as a signed integer, or throws an exception if this
+		//! value doesn't hold a number or it is out of range. Fractions are truncated.
+		std::int64_t toInt64() const;
+		//! @brief Returns the number as an unsigned integer, or throws an exception if this
+		//! value doesn't hold a number or it is out of range. Fractions are truncated.
+		std::uint64_t toUInt64() const;
+		//! @brief Returns the number as a double, or throws an exception 
+		//! if this value doesn't hold a number.
+		double toDouble() const;
 		
 		//! @brief Returns a reference to the string, or throws an exception 
 		//! if this value doesn't hold a string.
 		std::string& toString();
-		//! @brief Returns a reference to the string, or throws an exception 
-		//! if this value doesn't hold a string.
-		const std::string& toString() const;
+		//! @brief Returns a copy of the string, or throws an exception 
+		//! if this value doesn't hold a string. The value is left unchanged, so threads may
+		//! read it together: prefer toStringView() to avoid the copy.
+		std::string toString() const;
+		//! @brief Returns a view of the string, or throws an exception 
+		//! if this value doesn't hold a string. Never copies the string.
+		std::string_view toStringView() const;
 		
 		//! @brief Returns a reference to the array, or throws an exception 
 		//! if this value doesn't hold a array.
-		std::vector < Value >& toArray();
+		Array& toArray();
 		//! @brief Returns a reference to the array, or throws an exception 
 		//! if this value doesn't hold a array.
-		const std::vector < Value >& toArray() const;
+		const Array& toArray() const;
         
         //! @brief Returns a reference to the boolean, or throws an exception
         //! if this value doesn't hold a boolean.
@@ -126,8 +355,8 @@ public:
         //! if this value doesn't hold a boolean.
         const bool& toBoolean() const;
 		
-		//! @brief Returns the name of this value.
-		const std::string& name() const;
+		//! @brief Returns the name of this value, empty for the elements of an array.
+		std::string_view name() const;
 		
 		//! @brief Returns the value at given index if this value is an Array. 
 		Value& at(const std::size_t& index);
@@ -135,23 +364,33 @@ public:
 		const Value& at(const std::size_t& index) const;
         
         //! @brief Returns the Value for passed value name, only if this value is an Object.
-        Value& operator [](const std::string& name);
+        Value& operator [](std::string_view name);
         //! @brief Returns the Value for passed value name, only if this value is an Object.
-        const Value& operator [](const std::string& name) const;
+        const Value& operator [](std::string_view name) const;
         
-        //! @brief Writes the JSON Value into a string.
-        //! @param level The number of tabulation to insert.
+        //! @brief Writes the JSON Value into a string, see Writer.
+        //! @param level The nesting level the output starts at.
         //! @param printName Boolean false if we shouldn't print name (specific to Arrays).
         std::string str(unsigned level = 0, bool printName = true) const;
         
         //! @brief Changes the Value to a string.
         Value& operator=(const std::string& rhs);
+        //! @brief Changes the Value to a string, taking its buffer.
+        Value& operator=(std::string&& rhs);
         //! @brief Changes the Value to a number.
         Value& operator=(const Number& rhs);
+        //! @brief Changes the Value to an integer, stored exactly.
+        Value& operator=(std::int64_t rhs);
+        //! @brief Changes the Value to an unsigned integer, stored exactly.
+        Value& operator=(std::uint64_t rhs);
         //! @brief Changes the Value to an array.
-        Value& operator=(const std::vector < Value >& rhs);
+        Value& operator=(const Array& rhs);
+        //! @brief Changes the Value to an array, taking its elements.
+        Value& operator=(Array&& rhs);
         //! @brief Changes the Value to an object.
         Value& operator=(const JSON& rhs);
+        //! @brief Changes the Value to an object, taking its values.
+        Value& operator=(JSON&& rhs);
         //! @brief Changes the Value to a boolean.
         Value& operator=(bool rhs);
         
@@ -162,11 +401,11 @@ public:
         //! @brief Tries to convert this value to a number.
         explicit operator Number();
         //! @brief Tries to convert this value to a number.
-        explicit operator const Number() const;
+        explicit operator Number() const;
         //! @brief Tries to convert this value to an array.
-        operator std::vector < Value >();
+        operator Array();
         //! @brief Tries to convert this value to an array.
-        operator const std::vector < Value >() const;
+        operator const Array() const;
         //! @brief Tries to convert this value to an object.
         operator JSON();
         //! @brief Tries to convert this value to an object.
@@ -181,47 +420,64 @@ public:
         template < typename T > inline Value& operator << (const T& rhs) {
             JSON obj;
             rhs.toJSON(obj);
-            *this = Value(mName, obj);
+            *this = std::move(obj);
             return *this;
         }
         
         //! @brief Some stuff for normal structures.
-        template < > inline Value& operator << (const std::string& rhs) {
-            *this = Value(mName, rhs);
+        inline Value& operator << (const std::string& rhs) {
+            *this = rhs;
             return *this;
         }
         
         //! @brief Some stuff for normal structures.
-        template < > inline Value& operator << (const int& rhs) {
-            *this = Value(mName, (JSON::Number)rhs);
+        inline Value& operator << (const int& rhs) {
+            *this = static_cast < std::int64_t >(rhs);
             return *this;
         }
         
         //! @brief Some stuff for normal structures.
-        template < > inline Value& operator << (const Number& rhs) {
-            *this = Value(mName, rhs);
+        inline Value& operator << (const std::int64_t& rhs) {
+            *this = rhs;
             return *this;
         }
         
         //! @brief Some stuff for normal structures.
-        template < > inline Value& operator << (const std::vector<Value>& rhs) {
-            *this = Value(mName, rhs);
+        inline Value& operator << (const std::uint64_t& rhs) {
+            *this = rhs;
             return *this;
         }
         
         //! @brief Some stuff for normal structures.
-        template < > inline Value& operator << (const JSON& rhs) {
-            *this = Value(mName, rhs);
+        inline Value& operator << (const Number& rhs) {
+            *this = rhs;
+            return *this;
+        }
+        
+        //! @brief Some stuff for normal structures.
+        inline Value& operator << (const Array& rhs) {
+            *this = rhs;
+            return *this;
+        }
+        
+        //! @brief Some stuff for normal structures.
+        inline Value& operator << (const JSON& rhs) {
+            *this = rhs;
             return *this;
         }
         
         //! @brief Creates a Value for a std::vector of arbitrary type.
         template < typename T > inline Value& operator << (const std::vector < T >& rhs) {
-            *this = Value(mName, std::vector < Value >());
+            Array array;
+            array.reserve(rhs.size());
             
             for (auto& val : rhs) {
-                mArray.push_back(Value() << val);
+                Value element;
+                element << val;
+                array.push_back(std::move(element));
             }
+            
+            *this = std::move(array);
                 
             return *this;
         }
@@ -234,28 +490,42 @@ public:
                 lhs[el.first] << el.second;
             }
             
-            *this = Value(mName, lhs);
+            *this = std::move(lhs);
             return *this;
         }
         
         //! @brief Specialized function for basic types.
         inline const Value& operator >> (std::string& rhs) const {
             JSON_THROW_IF(!isString(), Exception("invalid string conversion"));
-            rhs = mString;
+            rhs = toStringView();
             return *this;
         }
         
         //! @brief Specialized function for basic types.
         inline const Value& operator >> (int& rhs) const {
             JSON_THROW_IF(!isNumber(), Exception("invalid number conversion"));
-            rhs = static_cast < int >(mNumber);
+            rhs = static_cast < int >(toInt64());
+            return *this;
+        }
+        
+        //! @brief Specialized function for basic types.
+        inline const Value& operator >> (std::int64_t& rhs) const {
+            JSON_THROW_IF(!isNumber(), Exception("invalid number conversion"));
+            rhs = toInt64();
+            return *this;
+        }
+        
+        //! @brief Specialized function for basic types.
+        inline const Value& operator >> (std::uint64_t& rhs) const {
+            JSON_THROW_IF(!isNumber(), Exception("invalid number conversion"));
+            rhs = toUInt64();
             return *this;
         }
         
         //! @brief Specialized function for basic types.
         inline const Value& operator >> (Number& rhs) const {
             JSON_THROW_IF(!isNumber(), Exception("invalid number conversion"));
-            rhs = mNumber;
+            rhs = toDouble();
             return *this;
         }
         
@@ -267,15 +537,15 @@ public:
         }
         
         //! @brief Specialized function for basic types.
-        inline const Value& operator >> (std::vector<Value>& rhs) const {
+        inline const Value& operator >> (Array& rhs) const {
             JSON_THROW_IF(!isArray(), Exception("invalid array conversion"));
-            rhs = mArray;
+            rhs = *mArray;
             return *this;
         }
         
         //! @brief Specialized function for basic types.
         inline const Value& operator >> (JSON& rhs) const {
-            JSON_THROW_IF(!isObject()||!mObject, Exception("invalid object conversion"));
+            JSON_THROW_IF(!isObject(), Exception("invalid object conversion"));
             rhs = *mObject;
             return *this;
         }
@@ -284,40 +554,1202 @@ public:
         //! The Value must have the T_OBJECT type, and a function `void fromJSON(const JSON&)` must be
         //! present in the deserialized class.
         template < typename T > inline const Value& operator >> (T& rhs) const {
-            JSON_THROW_IF(!isObject()||!mObject, Exception("invalid Object type conversion"));
+            JSON_THROW_IF(!isObject(), Exception("invalid Object type conversion"));
             rhs.fromJSON(*mObject);
             return *this;
         }
 	};
 	
-	//! @brief The Array representation.
-	typedef std::vector < Value > Array;
+	//! @brief A region holding whole documents.
+	//! Every node, key and string of a document loaded into an Arena is carved out of
+	//! a few large blocks, and destroying the Arena releases them all at once instead
+	//! of walking the tree. Documents loaded into an Arena are read-only and must not
+	//! outlive it; copying one out gives an independent heap document.
+	class Arena
+	{
+		//! @brief The bump allocator all documents are carved from.
+		std::pmr::monotonic_buffer_resource mResource;
+		
+		//! @brief Strings too long for their inline buffer, which keep a heap buffer
+		//! that must be freed with the arena.
+		std::vector < std::string* > mStrings;
+		
+		friend class JSON;
+		friend class Value;
+		friend class Reader;
+		
+		//! @brief Constructs a T in the arena.
+		template < typename T, typename... Args > T* make(Args&&... args) {
+			return new (mResource.allocate(sizeof(T), alignof(T))) T(std::forward < Args >(args)...);
+		}
+		
+		//! @brief Places the string in the arena.
+		std::string* makeString(std::string&& rhs);
+		
+	public:
+		//! @brief Constructs an empty Arena.
+		//! @param blockSize The size of the first block, later blocks grow geometrically.
+		explicit Arena(std::size_t blockSize = JSON_ARENA_BLOCK);
+		//! @brief Releases every document held by this Arena.
+		~Arena();
+		
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+		
+		//! @brief Returns the memory resource backing this Arena.
+		std::pmr::memory_resource* resource();
+		
+		//! @brief Releases every document held by this Arena, which can then be reused.
+		void release();
+	};
+	
+	//! @brief Receives the events of JSON::parse().
+	//! The events follow the content in order, and no tree is built: override the ones
+	//! needed, the others do nothing. Views passed to the events are only valid until
+	//! they return.
+	class Handler
+	{
+	public:
+		virtual ~Handler() = default;
+		
+		//! @brief Called on '{', before the members of the object.
+		virtual void startObject() {}
+		//! @brief Called on '}', after the members of the object.
+		virtual void endObject() {}
+		//! @brief Called on '[', before the elements of the array.
+		virtual void startArray() {}
+		//! @brief Called on ']', after the elements of the array.
+		virtual void endArray() {}
+		//! @brief Called with the key of each member, before its value.
+		virtual void key(std::string_view /*name*/) {}
+		//! @brief Called for a string, decoded.
+		virtual void string(std::string_view /*value*/) {}
+		//! @brief Called for a number with a fraction or an exponent, or out of the 64 bits range.
+		virtual void number(double /*value*/) {}
+		//! @brief Called for an integer. Calls number() unless overridden.
+		virtual void integer(std::int64_t value) { number(static_cast < double >(value)); }
+		//! @brief Called for an integer above the range of std::int64_t. Calls number() unless overridden.
+		virtual void unsignedInteger(std::uint64_t value) { number(static_cast < double >(value)); }
+		//! @brief Called for true or false.
+		virtual void boolean(bool /*value*/) {}
+		//! @brief Called for null.
+		virtual void null() {}
+	};
+	
+	//! @brief Parses a texted JSON fed in chunks, as they arrive from a socket or a pipe.
+	//! Events are sent to the handler as soon as they are complete, and only a token split
+	//! between two chunks is buffered. The input may hold several values in a row, like
+	//! a log stream.
+	class PushParser
+	{
+		//! @brief Receives the events.
+		Handler& mHandler;
+		
+		enum State : std::uint8_t { S_VALUE, S_KEY, S_COLON, S_AFTER, S_STRING, S_NUMBER, S_LITERAL };
+		//! @brief Holds what is expected from the next character.
+		State mState;
+		
+		//! @brief True if the current string is a key.
+		bool mIsKey;
+		//! @brief True if the next character of the current string is escaped.
+		bool mEscape;
+		//! @brief True if the current string holds escapes and must be decoded.
+		bool mHasEscape;
+		//! @brief True if a ',' was the last character read, so a bracket cannot follow.
+		bool mAfterComma;
+		
+		//! @brief Holds '{' or '[' for every open object or array.
+		std::vector < char > mStack;
+		
+		//! @brief Holds the beginning of a token split between two chunks.
+		std::string mBuffer;
+		
+		//! @brief The literal being read if S_LITERAL, and the number of characters read.
+		const char* mLiteral;
+		std::size_t mLiteralPos;
+		
+		//! @brief The current line and column, for error messages.
+		std::size_t mLine, mCol;
+		//! @brief The line and column where the current token began.
+		std::size_t mTokenLine, mTokenCol;
+		
+		//! @brief Skips whitespaces and returns the first other character, or end.
+		const char* skipWhitespace(const char* it, const char* end);
+		//! @brief Starts the value beginning with the character at it.
+		void startValue(const char* it);
+		//! @brief Closes the innermost object or array with the character at it.
+		void close(const char* it);
+		//! @brief Updates the state after a complete value.
+		void endValue();
+		//! @brief Sends the complete string token, quotes included.
+		void sendString(std::string_view token);
+		//! @brief Sends the complete number token.
+		void sendNumber(std::string_view token);
+		
+	public:
+		//! @brief Constructs a PushParser sending its events to the handler.
+		explicit PushParser(Handler& handler);
+		
+		PushParser(const PushParser&) = delete;
+		PushParser& operator=(const PushParser&) = delete;
+		
+		//! @brief Parses the next chunk of the input.
+		void feed(const char* data, std::size_t size);
+		
+		//! @brief Ends the input: sends a number it ended with, or throws an exception if
+		//! a value is incomplete. The parser can then be fed a new input.
+		void finish();
+	};
+	
+	class LazyDocument;
+	
+	//! @brief A value of a LazyDocument, decoded only when it is read.
+	//! A LazyValue is a position in the content: looking up a member or an element walks
+	//! the structural index of the document and skips other values whole. A missing
+	//! value is null, like NullValue, and looking into it gives another missing value.
+	class LazyValue
+	{
+		//! @brief The document, or null if this value is missing.
+		const LazyDocument* mDocument;
+		
+		//! @brief The offset of the first character of this value in the content.
+		std::uint32_t mBegin;
+		
+		//! @brief The structural of this value if it is an object, an array or a string,
+		//! or else the structural following it.
+		std::uint32_t mStructural;
+		
+		friend class LazyDocument;
+		
+		//! @brief Constructs the value beginning at begin.
+		LazyValue(const LazyDocument* document, std::uint32_t begin, std::uint32_t structural);
+		
+		//! @brief Returns the first character of this value, or zero if it is missing.
+		char first() const;
+		//! @brief Returns the structural following this value.
+		std::uint32_t next() const;
+		//! @brief Returns the value following the structural, which ends the previous one.
+		LazyValue valueAfter(std::uint32_t structural) const;
+		//! @brief Returns a Reader placed on this value.
+		Reader reader() const;
+		
+	public:
+		//! @brief Constructs a missing value.
+		LazyValue();
+		
+		//! @brief Returns true if this value is an object.
+		bool isObject() const;
+		//! @brief Returns true if this value is a number.
+		bool isNumber() const;
+		//! @brief Returns true if this value is a string.
+		bool isString() const;
+		//! @brief Returns true if this value is an array.
+		bool isArray() const;
+		//! @brief Returns true if this value is a boolean.
+		bool isBoolean() const;
+		//! @brief Returns true if this value is null or missing.
+		bool isNull() const;
+		
+		//! @brief Returns the member with specified name if this value is an object, or a missing value.
+		//! Members are looked up in order, so the first of duplicate members is found.
+		LazyValue operator [](std::string_view name) const;
+		//! @brief Returns the element at given index if this value is an array, or a missing value.
+		LazyValue at(std::size_t index) const;
+		//! @brief Returns the number of members or elements, or zero if this value is not a container.
+		std::size_t size() const;
+		
+		//! @brief Returns the decoded string, or throws an exception if this value doesn't hold a string.
+		std::string toString() const;
+		//! @brief Returns the number, or throws an exception if this value doesn't hold a number.
+		double toDouble() const;
+		//! @brief Returns the integer, or throws an exception if this value doesn't hold an integer in range.
+		std::int64_t toInt64() const;
+		//! @brief Returns the integer, or throws an exception if this value doesn't hold an integer in range.
+		std::uint64_t toUInt64() const;
+		//! @brief Returns the boolean, or throws an exception if this value doesn't hold a boolean.
+		bool toBoolean() const;
+		
+		//! @brief Decodes this value and everything it holds into a Value.
+		Value toValue() const;
+	};
+	
+	//! @brief A document decoded only where it is read.
+	//! Constructing it makes a single pass over the content, recording the offsets of its
+	//! structural characters, '{', '}', '[', ']', ':', ',' and quotes, and where each
+	//! object and array ends. Values are then decoded when read through a LazyValue. The
+	//! content must outlive the document, and is only checked as far as it is read.
+	class LazyDocument
+	{
+		//! @brief A structural character.
+		struct Structural
+		{
+			//! @brief The offset of the character in the content.
+			std::uint32_t offset;
+			
+			//! @brief For an opening bracket, the structural of the matching closing one.
+			std::uint32_t match;
+		};
+		
+		//! @brief The content.
+		std::string_view mContent;
+		
+		//! @brief The structurals, in order. Quotes come in pairs, escaped ones are left out.
+		std::vector < Structural > mStructurals;
+		
+		friend class LazyValue;
+		
+	public:
+		//! @brief Indexes the content.
+		explicit LazyDocument(std::string_view content);
+		
+		//! @brief Returns the top-level value.
+		LazyValue root() const;
+		
+		//! @brief Returns the member of the top-level object with specified name.
+		LazyValue operator [](std::string_view name) const;
+	};
+	
+	class MappedDocument;
+	
+	//! @brief A value of a MappedDocument, read in place from its image.
+	//! A MappedValue is the offset of a node in the image: looking up a member or an element
+	//! reads its node without decoding anything else. A missing value is null, like NullValue,
+	//! and looking into it gives another missing value.
+	class MappedValue
+	{
+		//! @brief The document, or null if this value is missing.
+		const MappedDocument* mDocument;
+		
+		//! @brief The offset of the node of this value in the image.
+		std::uint64_t mNode;
+		
+		friend class MappedDocument;
+		
+		//! @brief Constructs the value of the node at offset node.
+		MappedValue(const MappedDocument* document, std::uint64_t node);
+		
+		//! @brief Returns the type of the node of this value, see JSONImage.cpp.
+		unsigned type() const;
+		//! @brief Returns the offset of the block of the members or elements of this value, and
+		//! sets count to their number, or returns zero if this value is not a container.
+		std::uint64_t block(std::size_t& count) const;
+		//! @brief Copies this value and everything it holds into a Value with specified name.
+		Value toValue(std::string_view name) const;
+		
+	public:
+		//! @brief Constructs a missing value.
+		MappedValue();
+		
+		//! @brief Returns true if this value is an object.
+		bool isObject() const;
+		//! @brief Returns true if this value is a number.
+		bool isNumber() const;
+		//! @brief Returns true if this value is a string.
+		bool isString() const;
+		//! @brief Returns true if this value is an array.
+		bool isArray() const;
+		//! @brief Returns true if this value is a boolean.
+		bool isBoolean() const;
+		//! @brief Returns true if this value is null or missing.
+		bool isNull() const;
+		
+		//! @brief Returns the member with specified name if this value is an object, or a missing value.
+		//! Small objects are looked up in order, larger ones through their sorted keys.
+		MappedValue operator [](std::string_view name) const;
+		//! @brief Returns the element at given index if this value is an array, the member at given
+		//! index if it is an object, or a missing value.
+		MappedValue at(std::size_t index) const;
+		//! @brief Returns the key of the member at given index if this value is an object, or an empty view.
+		std::string_view key(std::size_t index) const;
+		//! @brief Returns the number of members or elements, or zero if this value is not a container.
+		std::size_t size() const;
+		
+		//! @brief Returns the string, a view into the image, or throws an exception if this value
+		//! doesn't hold a string.
+		std::string_view toString() const;
+		//! @brief Returns the number, or throws an exception if this value doesn't hold a number.
+		double toDouble() const;
+		//! @brief Returns the integer, or throws an exception if this value doesn't hold an integer in range.
+		std::int64_t toInt64() const;
+		//! @brief Returns the integer, or throws an exception if this value doesn't hold an integer in range.
+		std::uint64_t toUInt64() const;
+		//! @brief Returns the boolean, or throws an exception if this value doesn't hold a boolean.
+		bool toBoolean() const;
+		
+		//! @brief Copies this value and everything it holds into a Value.
+		Value toValue() const;
+	};
+	
+	//! @brief A document read in place from its image, written by JSON::toImage().
+	//! The image lays the document out with offsets instead of pointers: opening a file maps
+	//! it read-only, so that processes opening the same file share its pages, and checks only
+	//! its header. Each node is checked against the bounds of the image when it is read.
+	//! Images use the byte order of the machine that wrote them, and are rejected by others.
+	class MappedDocument
+	{
+		//! @brief Keeps the image alive, the mapped file if there is one.
+		std::shared_ptr < const void > mOwner;
+		
+		//! @brief The image.
+		std::string_view mImage;
+		
+		//! @brief The offset of the key table, and its number of keys.
+		std::uint64_t mKeys, mKeyCount;
+		
+		//! @brief The offset of the node of the top-level object.
+		std::uint64_t mRoot;
+		
+		friend class MappedValue;
+		
+		//! @brief Copies size bytes at offset in the image into data, checking the bounds.
+		void read(std::uint64_t offset, void* data, std::size_t size) const;
+		//! @brief Returns the key with specified id.
+		std::string_view key(std::uint32_t id) const;
+		
+	public:
+		//! @brief Checks the header of the image, which must outlive the document.
+		explicit MappedDocument(std::string_view image);
+		
+		//! @brief Maps the specified image file. The document keeps the file mapped, and so
+		//! do its copies.
+		static MappedDocument open(const std::string& file);
+		
+		//! @brief Returns the top-level value.
+		MappedValue root() const;
+		
+		//! @brief Returns the member of the top-level object with specified name.
+		MappedValue operator [](std::string_view name) const;
+	};
+	
+	//! @brief A query compiled once and run over many documents, without throwing.
+	//! A Path is either a JSON Pointer, RFC 6901, like "/store/book/0/title", or a path
+	//! starting with '$' made of steps:
+	//! - .key or ['key'], the member with that key, quotes being escaped with '\\';
+	//! - [n], the element at index n, counted from the end if n is negative;
+	//! - .* or [*], every member or element;
+	//! - [begin:end:step], the elements of a slice, each bound being optional.
+	//! Each key step remembers where it last found its member, which it looks at first in
+	//! the next object: documents of the same shape are looked up without searching.
+	class Path
+	{
+		//! @brief A step of the path.
+		struct Step
+		{
+			enum Kind : std::uint8_t { S_MEMBER, S_INDEX, S_WILDCARD, S_SLICE };
+			
+			//! @brief The kind of step.
+			Kind kind = S_MEMBER;
+			
+			//! @brief True if the step has an index, or a slice its beginning, or its end.
+			bool hasBegin = false, hasEnd = false;
+			
+			//! @brief The key of a member.
+			std::string key;
+			
+			//! @brief The index, or the bounds and the stride of a slice. A pointer token
+			//! which is an index also has it, for arrays.
+			std::int64_t begin = 0, end = 0, stride = 1;
+			
+			//! @brief The position the member was last found at.
+			mutable std::atomic < std::uint32_t > hint;
+			
+			Step();
+			Step(const Step& rhs);
+			Step& operator=(const Step& rhs);
+		};
+		
+		//! @brief The steps, in order.
+		std::vector < Step > mSteps;
+		
+		//! @brief True if every step selects a single value at most.
+		bool mSingle;
+		
+		//! @brief Parses the steps of a JSON Pointer.
+		void parsePointer(std::string_view pointer);
+		//! @brief Parses the steps of a path starting with '$'.
+		void parsePath(std::string_view path);
+		
+		//! @brief Returns the member of the step in the object, or null.
+		static const Value* member(const JSON& object, const Step& step);
+		//! @brief Returns the member or the element of a single step in the value, or null.
+		static const Value* select(const Value& value, const Step& step);
+		//! @brief Appends the values the steps from step select in the object, up to limit.
+		void collect(const JSON& object, std::size_t step, std::vector < const Value* >& results, std::size_t limit) const;
+		//! @brief Appends the values the steps from step select in the value, up to limit.
+		void collect(const Value& value, std::size_t step, std::vector < const Value* >& results, std::size_t limit) const;
+		
+	public:
+		//! @brief Compiles the JSON Pointer or the path, or throws an exception if it is invalid.
+		explicit Path(std::string_view expression);
+		
+		//! @brief Returns the first value selected in the document, or null. An empty path
+		//! selects the document itself, which is not a Value: null is returned.
+		const Value* find(const JSON& document) const;
+		//! @brief Returns the first value selected from the value, or null.
+		const Value* find(const Value& value) const;
+		
+		//! @brief Returns the values selected in the document, in order.
+		std::vector < const Value* > findAll(const JSON& document) const;
+		//! @brief Returns the values selected from the value, in order.
+		std::vector < const Value* > findAll(const Value& value) const;
+	};
+	
+	//! @brief A document which is never changed, shared by the threads reading it. Copying a
+	//! snapshot counts one more reader, and the document lives as long as a snapshot of it.
+	class Snapshot
+	{
+		std::shared_ptr < const JSON > mDocument;
+		
+	public:
+		//! @brief Constructs a snapshot of an empty document.
+		Snapshot();
+		//! @brief Constructs a snapshot of the document, taking its values.
+		explicit Snapshot(JSON document);
+		
+		//! @brief Returns the document.
+		const JSON& operator*() const noexcept;
+		//! @brief Returns the document.
+		const JSON* operator->() const noexcept;
+		//! @brief Returns the value with specified name, or NullValue.
+		const Value& operator[](std::string_view name) const;
+	};
+	
+	//! @brief Publishes the snapshot of a document read by many threads while another replaces
+	//! it, like a configuration reloaded. load() is wait-free and never sees a half-updated
+	//! document: readers count themselves in a slot while they take the current snapshot, and
+	//! store() waits for the readers counted before it replaced the snapshot to destroy it.
+	class AtomicDocument
+	{
+		//! @brief Counts the readers taking a snapshot, by parity of the epoch in which they
+		//! started. Threads are spread over slots so they seldom write the same cache line.
+		struct alignas(64) Slot
+		{
+			std::atomic < std::uint32_t > readers[2];
+		};
+		
+		//! @brief Holds the counts of readers.
+		mutable Slot mSlots[JSON_SNAPSHOT_SLOTS];
+		//! @brief Holds the current snapshot.
+		std::atomic < const Snapshot* > mCurrent;
+		//! @brief Holds the epoch, incremented twice at each store().
+		std::atomic < std::uint32_t > mEpoch;
+		//! @brief Serializes the writers.
+		std::mutex mStoring;
+		
+	public:
+		//! @brief Constructs the holder of an empty document.
+		AtomicDocument();
+		//! @brief Constructs the holder of a snapshot.
+		explicit AtomicDocument(Snapshot snapshot);
+		AtomicDocument(const AtomicDocument&) = delete;
+		AtomicDocument& operator=(const AtomicDocument&) = delete;
+		//! @brief Destroys the holder. No thread may be loading from it.
+		~AtomicDocument();
+		
+		//! @brief Returns the current snapshot. It is wait-free and makes no allocation.
+		Snapshot load() const;
+		//! @brief Replaces the current snapshot. Readers holding the previous one keep it.
+		void store(Snapshot snapshot);
+		//! @brief Replaces the current snapshot, and returns the previous one.
+		Snapshot exchange(Snapshot snapshot);
+	};
+	
+	//! @brief Keeps the document of a file current while the file changes, without restarting.
+	//! Changes are watched with inotify on Linux, and by checking the modification time of the
+	//! file elsewhere. A background thread waits until no change came for the debounce delay,
+	//! parses the file again and publishes the document only if it is valid: readers keep the
+	//! previous one otherwise, and load() never blocks.
+	class Watcher
+	{
+	public:
+		//! @brief Called on the background thread with each document published after a change.
+		//! It must not throw.
+		typedef std::function < void(const Snapshot&) > Callback;
+		
+		//! @brief Counts what the watcher did since it started.
+		struct Stats
+		{
+			//! @brief The changes notified, before debouncing.
+			std::uint64_t events = 0;
+			//! @brief The documents published after a change.
+			std::uint64_t reloads = 0;
+			//! @brief The changes leaving an invalid or unreadable file.
+			std::uint64_t failures = 0;
+		};
+		
+	private:
+		std::string mFile;
+		Callback mCallback;
+		std::chrono::milliseconds mDebounce;
+		//! @brief Holds the modification time and size of the file when it was last parsed.
+		std::pair < std::int64_t, std::uintmax_t > mIdentity;
+		AtomicDocument mDocument;
+		
+		std::atomic < std::uint64_t > mEvents;
+		std::atomic < std::uint64_t > mReloads;
+		std::atomic < std::uint64_t > mFailures;
+		
+		//! @brief Holds the message of the last failure, guarded by mMutex.
+		std::string mError;
+		//! @brief Tells the thread to stop, guarded by mMutex.
+		bool mStopping;
+		mutable std::mutex mMutex;
+		std::condition_variable mWakeUp;
+		//! @brief Holds the inotify descriptor, and the pipe waking the thread up, if any.
+		int mNotify;
+		int mPipe[2];
+		std::thread mThread;
+		
+		//! @brief Waits for changes until stopped.
+		void run();
+		//! @brief Parses the file if it changed since it was last parsed, and publishes the
+		//! document if it is valid.
+		void reload();
+		//! @brief Returns the modification time and size of the file.
+		std::pair < std::int64_t, std::uintmax_t > identity() const;
+		
+	public:
+		//! @brief Loads the file, which must be valid, and starts watching it.
+		//! @param callback Called with each document published after a change.
+		//! @param debounce The delay without change after which the file is parsed again.
+		explicit Watcher(const std::string& file, Callback callback = Callback(),
+		                 std::chrono::milliseconds debounce = std::chrono::milliseconds(JSON_WATCH_DEBOUNCE));
+		Watcher(const Watcher&) = delete;
+		Watcher& operator=(const Watcher&) = delete;
+		//! @brief Stops watching the file, waiting for a parse in progress.
+		~Watcher();
+		
+		//! @brief Returns the current document. It is wait-free.
+		Snapshot load() const;
+		//! @brief Returns the holder of the current document.
+		const AtomicDocument& document() const noexcept;
+		//! @brief Returns the counts of what the watcher did.
+		Stats stats() const noexcept;
+		//! @brief Returns the message of the last failure, or an empty string.
+		std::string error() const;
+	};
+	
+	//! @brief The names of the fields given to JSON_FIELDS(), split once out of their text.
+	//! Keys are mapped to fields through a perfect hash of the names: a single slot to look
+	//! at and a single name to compare.
+	class FieldNames
+	{
+		//! @brief The names, viewing the text.
+		std::vector < std::string_view > mNames;
+		
+		//! @brief The index of each name plus one in the slot of its hash, zero marks an empty slot.
+		std::vector < std::uint16_t > mSlots;
+		
+		//! @brief The seed for which no two names share a slot.
+		std::uint32_t mSeed;
+		
+		//! @brief Returns the slot of the name for the seed.
+		std::size_t slot(std::string_view name, std::uint32_t seed) const;
+		
+	public:
+		//! @brief Splits the text of the fields, names separated by commas.
+		FieldNames(const char* text);
+		
+		//! @brief Returns the name of the field at index.
+		std::string_view operator[](std::size_t index) const;
+		
+		//! @brief Returns the index of the field with specified name, or npos.
+		std::size_t find(std::string_view name) const;
+	};
+	
+	//! @brief Calls visitor(name, field) for each field, in their order, see JSON_FIELDS().
+	template < typename Visitor, typename... Fields >
+	static void visitFields(Visitor&& visitor, const FieldNames& names, Fields&... fields) {
+		std::size_t index = 0;
+		(visitor(names[index++], fields), ...);
+	}
+	
+	//! @brief Calls visitor(field) for the field at index, see JSON_FIELDS().
+	template < typename Visitor, typename... Fields >
+	static void visitField(std::size_t index, Visitor&& visitor, Fields&... fields) {
+		std::size_t i = 0;
+		((i++ == index ? visitor(fields) : void()), ...);
+	}
+	
+	//! @brief Reads a texted JSON value by value, for parseInto().
+	//! Values are read straight into their destination; members without a destination
+	//! are skipped without allocating.
+	class Cursor
+	{
+		//! @brief The reader of the content.
+		std::unique_ptr < Reader > mReader;
+		
+		//! @brief Returns the first character of the next value, after whitespaces.
+		char peek();
+		//! @brief Moves past the last character read.
+		void advance();
+		//! @brief Reads the '{' starting an object.
+		void beginObject();
+		//! @brief Reads the ',' before the next member unless first, then its key and ':'.
+		//! @param key Set to the key, valid until the next read.
+		//! @return false on the '}' ending the object.
+		bool nextKey(bool first, std::string_view& key);
+		//! @brief Reads the '[' starting an array.
+		void beginArray();
+		//! @brief Reads the ',' before the next element unless first.
+		//! @return false on the ']' ending the array.
+		bool nextElement(bool first);
+		//! @brief Reads an integer between min and max.
+		std::int64_t readInteger(std::int64_t min, std::int64_t max);
+		//! @brief Reads an integer up to max.
+		std::uint64_t readUnsigned(std::uint64_t max);
+		//! @brief Reads a number.
+		double readNumber();
+		//! @brief Reads true or false.
+		bool readBoolean();
+		//! @brief Reads null, returning false without moving if the next value is not null.
+		bool readNull();
+		//! @brief Reads a string.
+		void readString(std::string& string);
+		//! @brief Reads an object into a node.
+		void readObject(JSON& object);
+		//! @brief Reads any value into a node.
+		void readValue(Value& value);
+		//! @brief Skips the next value, checking it.
+		void skip();
+		
+		friend class JSON;
+		
+		//! @brief Reads the elements of the array.
+		template < typename T, typename Allocator > void read(std::vector < T, Allocator >& elements) {
+			elements.clear();
+			beginArray();
+			
+			for (bool first = true; nextElement(first); first = false) {
+				elements.emplace_back();
+				read(elements.back());
+			}
+		}
+		
+		//! @brief Reads the members of the object as entries.
+		template < typename T > void read(std::map < std::string, T >& members) {
+			std::string_view key;
+			members.clear();
+			beginObject();
+			
+			for (bool first = true; nextKey(first, key); first = false)
+				read(members[std::string(key)]);
+		}
+		
+		//! @brief Reads the value, or resets it on null.
+		template < typename T > void read(std::optional < T >& value) {
+			if (readNull())
+				value.reset();
+			else
+				read(value.emplace());
+		}
+		
+		//! @brief Reads a boolean, a string, a number, a node, or a structure declaring its
+		//! fields with JSON_FIELDS(). Structures only having fromJSON() go through a JSON.
+		template < typename T > void read(T& value) {
+			if constexpr (std::is_same < T, bool >::value)
+				value = readBoolean();
+			
+			else if constexpr (std::is_same < T, std::string >::value)
+				readString(value);
+			
+			else if constexpr (std::is_integral < T >::value && std::is_signed < T >::value)
+				value = static_cast < T >(readInteger(std::numeric_limits < T >::min(), std::numeric_limits < T >::max()));
+			
+			else if constexpr (std::is_integral < T >::value)
+				value = static_cast < T >(readUnsigned(std::numeric_limits < T >::max()));
+			
+			else if constexpr (std::is_floating_point < T >::value)
+				value = static_cast < T >(readNumber());
+			
+			else if constexpr (std::is_same < T, JSON >::value)
+				readObject(value);
+			
+			else if constexpr (std::is_same < T, Value >::value)
+				readValue(value);
+			
+			else if constexpr (HasFields < T >::value) {
+				const FieldNames& names = T::fieldNames();
+				std::string_view key;
+				beginObject();
+				
+				for (bool first = true; nextKey(first, key); first = false) {
+					std::size_t index = names.find(key);
+					
+					if (index == std::string_view::npos)
+						skip();
+					else
+						value.visitField(index, [this](auto& field) { read(field); });
+				}
+			}
+			
+			else {
+				static_assert(HasFromJSON < T >::value, "JSON::parseInto() cannot read this type: declare its fields "
+				                                        "with JSON_FIELDS() or give it a fromJSON(const JSON&) function.");
+				JSON object;
+				readObject(object);
+				value.fromJSON(object);
+			}
+		}
+		
+	public:
+		//! @brief Constructs a Cursor at the start of the content.
+		explicit Cursor(std::string_view content);
+		//! @brief Destroys the reader.
+		~Cursor();
+		
+		Cursor(const Cursor&) = delete;
+		Cursor& operator=(const Cursor&) = delete;
+		
+		//! @brief Checks that only whitespaces are left.
+		void finish();
+	};
+	
+	//! @brief Writes documents as texted JSON into a single growing buffer.
+	//! The buffer is reused from one document to the next. A Writer constructed with a
+	//! stream or a file descriptor hands it over every JSON_WRITER_BLOCK bytes, and when
+	//! flushed or destroyed.
+	class Writer
+	{
+	public:
+		//! @brief Selects how the output is laid out.
+		enum Layout
+		{
+			//! @brief No whitespace at all.
+			L_COMPACT,
+			//! @brief One member or element per line, indented by nesting level.
+			L_PRETTY
+		};
+		
+	private:
+		//! @brief Holds the output not handed over yet.
+		std::string mBuffer;
+		
+		//! @brief The stream the output goes to, or null.
+		std::ostream* mStream;
+		
+		//! @brief The file descriptor the output goes to, or -1.
+		int mFd;
+		
+		//! @brief The layout of the output.
+		Layout mLayout;
+		
+		//! @brief The indentation of one nesting level.
+		std::string mIndent;
+		
+		//! @brief The current nesting level.
+		unsigned mLevel;
+		
+		//! @brief Starts a new line at the current level, in L_PRETTY.
+		void newLine();
+		//! @brief Opens an object or an array, '{' or '['.
+		void open(char bracket);
+		//! @brief Separates an element or a member from the previous one and starts its line.
+		void next(bool first);
+		//! @brief Closes an object or an array, '}' or ']', of count elements or members.
+		void close(char bracket, std::size_t count);
+		//! @brief Writes the name of a member and its ':'.
+		void writeName(std::string_view name);
+		//! @brief Writes the number exactly.
+		void writeInteger(std::int64_t number);
+		//! @brief Writes the number exactly.
+		void writeUnsigned(std::uint64_t number);
+		//! @brief Writes the number in its shortest form that reads back the same.
+		void writeNumber(double number);
+		//! @brief Writes the payload of the value.
+		void writePayload(const Value& value);
+		//! @brief Writes the members of the object.
+		void writeObject(const JSON& object);
+		//! @brief Writes the elements of the array.
+		void writeArray(const Array& array);
+		//! @brief Writes the string quoted and escaped.
+		void writeString(std::string_view string);
+		//! @brief Hands the buffer over if it is full.
+		void spill();
+		
+		friend class JSON;
+		friend class Value;
+		friend class BinaryWriter;
+		
+		//! @brief Writes the elements of the container.
+		template < typename T, typename Allocator > void writeText(const std::vector < T, Allocator >& elements) {
+			open('[');
+			
+			for (std::size_t i = 0; i < elements.size(); ++i) {
+				next(i == 0);
+				writeText(elements[i]);
+				spill();
+			}
+			
+			close(']', elements.size());
+		}
+		
+		//! @brief Writes the entries of the map as members.
+		template < typename T > void writeText(const std::map < std::string, T >& members) {
+			std::size_t count = 0;
+			open('{');
+			
+			for (auto& member : members) {
+				next(count++ == 0);
+				writeName(member.first);
+				writeText(member.second);
+				spill();
+			}
+			
+			close('}', count);
+		}
+		
+		//! @brief Writes the value, or null if there is none.
+		template < typename T > void writeText(const std::optional < T >& value) {
+			if (value)
+				writeText(*value);
+			else
+				mBuffer.append("null");
+		}
+		
+		//! @brief Writes a boolean, a string, a number, a node, or a structure declaring its
+		//! fields with JSON_FIELDS(). Structures only having toJSON() go through a JSON.
+		template < typename T > void writeText(const T& value) {
+			if constexpr (std::is_same < T, bool >::value)
+				mBuffer.append(value ? "true" : "false");
+			
+			else if constexpr (std::is_convertible < const T&, std::string_view >::value)
+				writeString(value);
+			
+			else if constexpr (std::is_integral < T >::value && std::is_signed < T >::value)
+				writeInteger(value);
+			
+			else if constexpr (std::is_integral < T >::value)
+				writeUnsigned(value);
+			
+			else if constexpr (std::is_floating_point < T >::value)
+				writeNumber(value);
+			
+			else if constexpr (std::is_same < T, JSON >::value)
+				writeObject(value);
+			
+			else if constexpr (std::is_same < T, Value >::value)
+				writePayload(value);
+			
+			else if constexpr (HasFields < T >::value) {
+				std::size_t count = 0;
+				open('{');
+				
+				value.visitFields([this, &count](std::string_view name, const auto& field) {
+					next(count++ == 0);
+					writeName(name);
+					writeText(field);
+				});
+				
+				close('}', count);
+			}
+			
+			else {
+				static_assert(HasToJSON < T >::value, "JSON::Writer cannot write this type: declare its fields with "
+				                                       "JSON_FIELDS() or give it a toJSON(JSON&) function.");
+				JSON object;
+				value.toJSON(object);
+				writeObject(object);
+			}
+		}
+		
+	public:
+		//! @brief Constructs a Writer keeping its output in its buffer.
+		//! @param level The nesting level the output starts at.
+		explicit Writer(Layout layout = L_PRETTY, std::string_view indent = "\t", unsigned level = 0);
+		//! @brief Constructs a Writer handing its output to the stream.
+		explicit Writer(std::ostream& stream, Layout layout = L_PRETTY, std::string_view indent = "\t");
+		//! @brief Constructs a Writer handing its output to the file descriptor, which stays open.
+		explicit Writer(int fd, Layout layout = L_PRETTY, std::string_view indent = "\t");
+		//! @brief Flushes the output.
+		~Writer();
+		
+		Writer(const Writer&) = delete;
+		Writer& operator=(const Writer&) = delete;
+		
+		//! @brief Writes the object.
+		Writer& write(const JSON& object);
+		//! @brief Writes the value. Its name is written if it has one.
+		Writer& write(const Value& value);
+		
+		//! @brief Writes the value straight as text, without building nodes.
+		//! Structures declare their fields with JSON_FIELDS(); booleans, strings, numbers,
+		//! std::vector, std::map with string keys, std::optional and nodes are written as is.
+		template < typename T > Writer& serialize(const T& value) {
+			writeText(value);
+			spill();
+			return *this;
+		}
+		
+		//! @brief Returns the output not handed over yet, all of it without a stream or a file.
+		std::string_view content() const;
+		//! @brief Empties the buffer, keeping its storage.
+		void clear();
+		//! @brief Hands the buffer over to the stream or the file descriptor.
+		void flush();
+	};
 	
-	//! @brief The values in this object.
-	Array mValues;
+	//! @brief Writes documents in a binary format, CBOR or MessagePack, into a buffer, a stream
+	//! or a file descriptor, like a Writer.
+	//! Objects are written as maps and arrays as arrays, integers exactly in their smallest form,
+	//! and other numbers as single floats when they hold them exactly, as doubles otherwise.
+	//! Documents written one after another form a stream that a BinaryReader or a
+	//! BinaryPushParser reads back in turn.
+	class BinaryWriter
+	{
+		//! @brief Holds the output and hands it over, laid out as is.
+		Writer mOutput;
+		
+		//! @brief The format of the output.
+		BinaryFormat mFormat;
+		
+		friend class JSON;
+		
+		//! @brief Writes the lowest size bytes of the value, in big-endian order.
+		void writeBigEndian(std::uint64_t value, unsigned size);
+		//! @brief Writes the head of a CBOR item of the major type, 0 to 7, with its argument.
+		void writeHead(std::uint8_t major, std::uint64_t argument);
+		//! @brief Writes the head of a MessagePack map, array or string of size entries, with
+		//! its fixed form for sizes below limit and its codes for 8, 16 and 32 bits sizes, if any.
+		void writeSize(std::uint8_t fixed, std::size_t limit, int code8, std::uint8_t code16, std::size_t size);
+		//! @brief Writes the number exactly.
+		void writeInteger(std::int64_t number);
+		//! @brief Writes the number exactly.
+		void writeUnsigned(std::uint64_t number);
+		//! @brief Writes the number as a single float if it holds it exactly, or as a double.
+		void writeNumber(double number);
+		//! @brief Writes the string as a text string.
+		void writeString(std::string_view string);
+		//! @brief Writes the payload of the value.
+		void writePayload(const Value& value);
+		//! @brief Writes the object as a map.
+		void writeObject(const JSON& object);
+		//! @brief Writes the elements of the array.
+		void writeArray(const Array& array);
+		
+	public:
+		//! @brief Constructs a BinaryWriter keeping its output in its buffer.
+		explicit BinaryWriter(BinaryFormat format);
+		//! @brief Constructs a BinaryWriter handing its output to the stream, opened in binary mode.
+		BinaryWriter(std::ostream& stream, BinaryFormat format);
+		//! @brief Constructs a BinaryWriter handing its output to the file descriptor, which stays open.
+		BinaryWriter(int fd, BinaryFormat format);
+		
+		//! @brief Writes the object.
+		BinaryWriter& write(const JSON& object);
+		//! @brief Writes the payload of the value, without its name.
+		BinaryWriter& write(const Value& value);
+		
+		//! @brief Returns the output not handed over yet, all of it without a stream or a file.
+		std::string_view content() const;
+		//! @brief Empties the buffer, keeping its storage.
+		void clear();
+		//! @brief Hands the buffer over to the stream or the file descriptor.
+		void flush();
+	};
+	
+	//! @brief Reads documents in a binary format, CBOR or MessagePack, out of data holding one
+	//! or several of them in a row.
+	//! Maps are read as objects and must have string keys, byte strings are read as strings,
+	//! and integers keep their exact value. CBOR tags are skipped, and undefined is read as null.
+	class BinaryReader
+	{
+		//! @brief A decoded item, see JSONBinary.cpp.
+		struct Item;
+		
+		//! @brief The data being read.
+		std::string_view mData;
+		
+		//! @brief The offset of the next byte to read.
+		std::size_t mPos;
+		
+		//! @brief The format of the data.
+		BinaryFormat mFormat;
+		
+		//! @brief Holds the chunks of a CBOR string of indefinite length, joined.
+		std::string mScratch;
+		
+		//! @brief Returns the name of the format, for error messages.
+		const char* formatName() const;
+		//! @brief Throws an exception if less than size bytes are left.
+		void need(std::size_t size) const;
+		//! @brief Reads an integer of size bytes stored in big-endian order.
+		std::uint64_t readBigEndian(std::size_t size);
+		//! @brief Reads the next item.
+		Item next();
+		//! @brief Reads the next CBOR item.
+		Item nextCBOR();
+		//! @brief Reads the next MessagePack item.
+		Item nextMessagePack();
+		//! @brief Returns true if the map or array has an entry at index, reading the break
+		//! ending it otherwise if its length is indefinite.
+		bool more(const Item& container, std::size_t index);
+		//! @brief Reads the key of a member, which must be a string.
+		std::string_view readKey();
+		//! @brief Reads the item and what it holds into a Value.
+		Value readValue(std::string_view name, const Item& item);
+		//! @brief Reads the members of the map.
+		JSON readObject(const Item& item);
+		//! @brief Reads the elements of the array.
+		Array readArray(const Item& item);
+		//! @brief Sends the events of the item and what it holds to the handler.
+		void parseValue(const Item& item, Handler& handler);
+		
+	public:
+		//! @brief Constructs a BinaryReader over the data, which must outlive it.
+		BinaryReader(std::string_view data, BinaryFormat format);
+		
+		//! @brief Returns true once all the data is read.
+		bool atEnd() const;
+		//! @brief Returns the offset of the next byte to read.
+		std::size_t position() const;
+		
+		//! @brief Reads the next document, which must be a map.
+		JSON read();
+		//! @brief Reads the next item, whatever it is, and sends its events to the handler.
+		void read(Handler& handler);
+	};
+	
+	//! @brief Reads documents in a binary format fed in chunks, as they arrive from a socket
+	//! or a pipe, and sends their events to a handler.
+	//! The bytes of a document are buffered until it is complete: the heads of its items are
+	//! scanned as they arrive, so that each byte is scanned once, and the events of the whole
+	//! document are then sent in a row.
+	class BinaryPushParser
+	{
+		//! @brief Receives the events.
+		Handler& mHandler;
+		
+		//! @brief The format of the input.
+		BinaryFormat mFormat;
+		
+		//! @brief Holds the bytes of the documents received and not sent yet.
+		std::string mBuffer;
+		
+		//! @brief The offset in mBuffer of the document being received.
+		std::size_t mStart;
+		
+		//! @brief The offset in mBuffer of the next head to scan.
+		std::size_t mScanned;
+		
+		//! @brief The number of items each open map, array, tag or string still holds, or
+		//! std::uint64_t(-1) if its length is indefinite.
+		std::vector < std::uint64_t > mPending;
+		
+		//! @brief The offset of mBuffer in the input, for error messages.
+		std::size_t mOffset;
+		
+		//! @brief Ends an item, and the items holding it that are complete with it. Sends
+		//! the document once it is complete itself.
+		void endItem();
+		
+	public:
+		//! @brief Constructs a BinaryPushParser sending its events to the handler.
+		BinaryPushParser(Handler& handler, BinaryFormat format);
+		
+		BinaryPushParser(const BinaryPushParser&) = delete;
+		BinaryPushParser& operator=(const BinaryPushParser&) = delete;
+		
+		//! @brief Reads the next chunk of the input.
+		void feed(const char* data, std::size_t size);
+		
+		//! @brief Ends the input: throws an exception if a document is incomplete. The parser
+		//! can then be fed a new input.
+		void finish();
+	};
+	
+private:
+	//! @brief The values of an object and their index.
+	struct Members
+	{
+		//! @brief The values, in insertion order.
+		Array values;
+		
+		//! @brief Open-addressed hash table of positions in values, zero marks an empty slot.
+		//! It stays empty until the object grows past JSON_INDEX_THRESHOLD values.
+		std::pmr::vector < std::uint32_t > index;
+		
+		//! @brief True if the values view the loaded content: copies copy them instead of
+		//! sharing them.
+		bool unshared = false;
+		
+		//! @brief True if the members live in an Arena, which frees them.
+		bool borrowed = false;
+		
+		//! @brief Constructs empty members allocating from the resource.
+		explicit Members(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+		//! @brief Copies the members on the heap.
+		Members(const Members& rhs);
+	};
+	
+	//! @brief The members of this object, or null while it is empty. Heap members are a node
+	//! shared by the copies of this object until one changes them.
+	Members* mMembers = nullptr;
+	
+	//! @brief Heap objects, arrays and strings are nodes shared by the copies holding them,
+	//! and counting their owners in this many bytes in front of them.
+	static constexpr std::size_t NODE_HEADER = alignof(std::max_align_t);
+	//! @brief Creates a node owned once.
+	template < typename T, typename... Args > static T* makeNode(Args&&... args);
+	//! @brief Returns the count of owners of a node.
+	static std::atomic < std::uint32_t >& owners(const void* node) noexcept;
+	//! @brief Adds an owner to a node.
+	template < typename T > static T* retainNode(T* node) noexcept;
+	//! @brief Removes an owner from a node, destroying it with its last owner.
+	template < typename T > static void releaseNode(T* node) noexcept;
+	//! @brief Replaces a node shared with other owners by a copy owned once.
+	template < typename T > static void detachNode(T*& node);
+	
+	//! @brief Returns the values in this object.
+	const Array& values() const noexcept;
+	//! @brief Returns the members of this object before changing them: created if it has
+	//! none yet, copied if another object shares them.
+	Members& members();
+	
+	//! @brief Returns the position of the value with specified name, or values().size().
+	std::size_t find(std::string_view name) const;
+	//! @brief Appends the specified Value and records it in the index.
+	Value& insert(Value&& value);
+	//! @brief Rebuilds the index for the current values.
+	void reindex();
 	
 public:
 	
 	//! @brief Constructs a new JSON object. 
 	JSON() = default;
-	//! @brief Copies the JSON object.
-	JSON(const JSON&) = default;
+	//! @brief Constructs a JSON object from a list of named values.
+	JSON(Array values);
+	//! @brief Constructs a new JSON object allocating its values from the arena.
+	explicit JSON(Arena& arena);
+	//! @brief Copies the JSON object, sharing its values until either changes them.
+	JSON(const JSON& rhs);
+	//! @brief Moves the JSON object. The moved-from object is left empty.
+	JSON(JSON&& rhs) noexcept;
+	//! @brief Destroys the JSON object, and its values if it was their last owner.
+	~JSON();
+	
+	//! @brief Copies the JSON object, sharing its values until either changes them.
+	JSON& operator=(const JSON& rhs);
+	//! @brief Moves the JSON object. The moved-from object is left empty.
+	JSON& operator=(JSON&& rhs) noexcept;
 	
 	//! @brief Returns the value with specified name.
-	//! If this value doesn't exist, a NullValue is returned. 
-	Value& value(const std::string& name);
+	//! If this value doesn't exist, a null value is returned. It belongs to the calling thread,
+	//! and is null again at its next missing lookup.
+	//! Names are compared by address first: looking up an interned key, see intern(), is faster.
+	Value& value(std::string_view name);
 	//! @brief Returns the value with specified name.
 	//! If this value doesn't exist, a NullValue is returned. 
-	const Value& value(const std::string& name) const;
+	const Value& value(std::string_view name) const;
 	
 	//! @brief Returns the converted value if existing.
 	//! @param name The name of the value to find and retrieve. 
 	//! @param def The default value returned if not found.
-	const std::string& valueOf(const std::string& name, const std::string& def) const;
+	std::string valueOf(const std::string& name, const std::string& def) const;
 	//! @brief Returns the converted value if existing.
 	//! @param name The name of the value to find and retrieve. 
 	//! @param def The default value returned if not found.
-	const Number& valueOf(const std::string& name, const Number& def) const;
+	Number valueOf(const std::string& name, const Number& def) const;
 	//! @brief Returns the converted value if existing.
 	//! @param name The name of the value to find and retrieve. 
 	//! @param def The default value returned if not found.
@@ -330,10 +1762,10 @@ public:
 	//! @brief Returns the value with specified name.
 	//! If this value doesn't exist, a NullValue is created with the specified name and a reference
     //! to the newly created Value is returned.
-	Value& operator[](const std::string& name);
+	Value& operator[](std::string_view name);
 	//! @brief Returns the value with specified name.
 	//! If this value doesn't exist, a NullValue is returned. 
-	const Value& operator[](const std::string& name) const;
+	const Value& operator[](std::string_view name) const;
 	
 	//! @brief Returns the first iterator in this object. 
 	Array::iterator begin();
@@ -351,13 +1783,36 @@ public:
 	
 	//! @brief Adds the specified Value. 
 	void addValue(const Value& value);
+	//! @brief Adds the specified Value, moving it into place.
+	void addValue(Value&& value);
     
-    //! @brief Writes the JSON Object into a string.
-    //! @param level The number of tabulation to insert.
+    //! @brief Writes the JSON Object into a string, see Writer.
+    //! @param level The nesting level the output starts at.
     std::string str(unsigned level = 0) const;
+    
+    //! @brief Writes the JSON Object as CBOR, see BinaryWriter.
+    std::string toCBOR() const;
+    
+    //! @brief Writes the JSON Object as MessagePack, see BinaryWriter.
+    std::string toMessagePack() const;
+    
+    //! @brief Writes the JSON Object as an image, to be read in place by a MappedDocument.
+    std::string toImage() const;
+    
+    //! @brief Writes the JSON Object as an image into the specified file, see toImage().
+    //! The file is replaced whole, by renaming another over it: processes which mapped it keep
+    //! reading the previous image.
+    void saveImage(const std::string& file) const;
+	
+	//! @brief Returns the copy of key in the pool shared by every document and thread, or an
+	//! empty view if the key is longer than JSON_INTERN_MAX or the pool already holds
+	//! JSON_INTERN_LIMIT keys. Names of values are interned when they are assigned, so
+	//! repeated keys are stored once; the pool is never freed.
+	static std::string_view intern(std::string_view key);
 	
-	//! @brief The Null Value returned each time value() returns an invalid value.
-	static Value NullValue;
+	//! @brief The Null Value returned each time value() const returns an invalid value. It is
+	//! constant, and initialized before any code runs, so every thread may read it.
+	static const Value NullValue;
 	
 public:
 	//! @brief Loads the specified file from a texted JSON. 
@@ -365,7 +1820,74 @@ public:
 	static JSON load(const std::string& file);
     
     //! @brief Loads the content as a texted JSON.
-    static JSON loadContent(const std::string& content);
+    //! @param storage S_IN_SITU to have keys and strings view the content instead of copying it.
+    static JSON loadContent(std::string_view content, Storage storage = S_COPY);
+    
+    //! @brief Loads the specified file into the arena.
+    //! @return The document, valid as long as the arena is.
+    static const JSON& load(const std::string& file, Arena& arena);
+    
+    //! @brief Loads the content as a texted JSON into the arena.
+    //! @return The document, valid as long as the arena is.
+    static const JSON& loadContent(std::string_view content, Arena& arena);
+    
+    //! @brief Reads the data as a CBOR document, a map, see BinaryReader.
+    static JSON fromCBOR(std::string_view data);
+    
+    //! @brief Reads the data as a MessagePack document, a map, see BinaryReader.
+    static JSON fromMessagePack(std::string_view data);
+    
+    //! @brief Loads the content as a texted JSON array.
+    //! Large arrays are split into pieces of at least JSON_ARRAY_PIECE bytes, parsed on a pool
+    //! of threads. The pieces start at commas guessed to be between elements; each guess is
+    //! checked when the piece before ends on it, and the elements after a wrong guess are
+    //! parsed again on the calling thread.
+    //! @param threads The number of threads, 0 for one per core, or 1 to parse serially.
+    static Array loadArrayContent(std::string_view content, unsigned threads = 0);
+    
+    //! @brief Loads the specified file as a texted JSON array, see loadArrayContent().
+    static Array loadArray(const std::string& file, unsigned threads = 0);
+    
+    //! @brief Receives the records of loadLines(), in the order of their lines.
+    typedef std::function < void(JSON&& record) > RecordCallback;
+    
+    //! @brief Loads the content as JSON Lines, an object per line, blank lines being skipped.
+    //! The content is split at newlines into chunks of up to JSON_LINES_CHUNK bytes, which
+    //! a pool of threads parses, each thread taking chunks from the others once its own
+    //! share is done.
+    //! @param threads The number of threads, or 0 for one per core.
+    //! @return The records, in the order of their lines.
+    static std::vector < JSON > loadLinesContent(std::string_view content, unsigned threads = 0);
+    
+    //! @brief Loads the content as JSON Lines, see loadLinesContent(), and sends each record
+    //! to the callback once its chunk and all the chunks before it are parsed. The callback
+    //! is called from the threads of the pool, one call at a time. When a line is invalid,
+    //! the records before it are sent and the error is thrown.
+    static void loadLinesContent(std::string_view content, const RecordCallback& callback, unsigned threads = 0);
+    
+    //! @brief Loads the specified file as JSON Lines, see loadLinesContent().
+    static std::vector < JSON > loadLines(const std::string& file, unsigned threads = 0);
+    
+    //! @brief Loads the specified file as JSON Lines and sends its records to the callback.
+    static void loadLines(const std::string& file, const RecordCallback& callback, unsigned threads = 0);
+    
+    //! @brief Reads the content straight into value, in a single pass without building nodes.
+    //! Structures declare their fields with JSON_FIELDS(): members are matched to fields by
+    //! their keys, and members without a field are skipped. Fields may be booleans, strings,
+    //! numbers, std::vector, std::map with string keys, std::optional, nodes, or other such
+    //! structures; integers out of the range of their field are rejected.
+    template < typename T > static void parseInto(std::string_view content, T& value) {
+        Cursor cursor(content);
+        cursor.read(value);
+        cursor.finish();
+    }
+    
+    //! @brief Reads the content as a texted JSON and sends its events to the handler,
+    //! without building a document. The content may hold any JSON value.
+    static void parse(std::string_view content, Handler& handler);
+    
+    //! @brief Reads the specified file and sends its events to the handler, see parse().
+    static void parseFile(const std::string& file, Handler& handler);
 };
 
 std::ostream& operator << (std::ostream& out, const JSON& obj);
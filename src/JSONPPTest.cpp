@@ -5,6 +5,70 @@
 
 #include <iostream>
 #include <chrono>
+#include <cstdlib>
+#include <new>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <map>
+#include <thread>
+
+#if defined(__linux__)
+#   include <unistd.h>
+#endif
+
+//! @brief Counts every global allocation made by the test program and the library, from any thread.
+static std::atomic < std::size_t > gAllocations(0);
+
+void* operator new(std::size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+//! @brief Returns the number of allocations made while parsing a chain of
+//! `depth` nested objects.
+static std::size_t nestedAllocations(unsigned depth)
+{
+    std::string content;
+    
+    for (unsigned i = 0; i < depth; ++i)
+        content += "{ \"key\": ";
+    
+    content += "{ \"leaf\": \"value\" }";
+    
+    for (unsigned i = 0; i < depth; ++i)
+        content += " }";
+    
+    std::size_t before = gAllocations;
+    JSON::loadContent(content);
+    return gAllocations - before;
+}
 
 struct T1
 {
@@ -22,6 +86,1177 @@ struct T1
     }
 };
 
+struct Point
+{
+    int x;
+    double y;
+    std::string label;
+    
+    JSON_FIELDS(x, y, label)
+};
+
+struct Twice
+{
+    int x;
+    
+    JSON_FIELDS(x, x)
+};
+
+struct Shape
+{
+    std::vector < Point > points;
+    std::map < std::string, std::uint64_t > tags;
+    std::optional < bool > hidden;
+    T1 legacy;
+    
+    JSON_FIELDS( points,
+                 tags, hidden,legacy )
+};
+
+//! @brief Parses an object with `count` members plus a duplicate of the first one,
+//! and checks lookups, insertion order and duplicate replacement.
+static void checkLargeObject(unsigned count)
+{
+    std::string content = "{";
+    
+    for (unsigned i = 0; i < count; ++i)
+        content += "\"key" + std::to_string(i) + "\": \"" + std::to_string(i) + "\", ";
+    
+    content += "\"key0\": \"replaced\" }";
+    
+    JSON obj = JSON::loadContent(content);
+    JSON_THROW_IF(obj.value("key0").toString() != "replaced", JSON::Exception("duplicate key was not replaced."));
+    JSON_THROW_IF(!obj.value("missing").isNull(), JSON::Exception("missing key was found."));
+    
+    unsigned i = 0;
+    for (auto& value : obj)
+    {
+        JSON_THROW_IF(value.name() != "key" + std::to_string(i), JSON::Exception("insertion order lost at %u.", i));
+        JSON_THROW_IF(&obj["key" + std::to_string(i)] != &value, JSON::Exception("lookup failed at %u.", i));
+        ++i;
+    }
+    
+    JSON_THROW_IF(i != count, JSON::Exception("expected %u values, got %u.", count, i));
+    
+    // Assigning a named value to a member keeps the key the member is indexed under.
+    JSON other = JSON::loadContent("{\"zz\": 42}");
+    obj["key3"] = other["zz"];
+    obj["key4"] = JSON::Value("zz", std::string("moved"));
+    
+    JSON_THROW_IF(obj.value("key3").toInt64() != 42 || obj.value("key4").toString() != "moved" ||
+                  !obj.value("zz").isNull() || obj.begin()[3].name() != "key3",
+                  JSON::Exception("assignment renamed a member."));
+    
+    // Array elements have no name: assigned to a member, they take its key.
+    JSON d2;
+    JSON array = JSON::loadContent("{\"arr\": [1, 2]}");
+    d2["x"] = array["arr"].toArray()[0];
+    JSON reloaded = JSON::loadContent(JSON::Value("", d2).str());
+    
+    d2.addValue(JSON::Value("", JSON::Number(2)));
+    JSON_THROW_IF(reloaded.value("x").toInt64() != 1 || JSON::Value("", d2).str().find("\"\": 2") == std::string::npos,
+                  JSON::Exception("a member was written without its key."));
+}
+
+//! @brief Loads the file in an arena and checks it matches the heap document, survives
+//! being copied out of the arena, and costs fewer allocations.
+static void checkArena(const std::string& file)
+{
+    std::size_t before = gAllocations;
+    JSON heap = JSON::load(file);
+    std::size_t heapAllocations = gAllocations - before;
+    
+    JSON copy;
+    
+    {
+        JSON::Arena arena;
+        before = gAllocations;
+        const JSON& doc = JSON::load(file, arena);
+        std::size_t arenaAllocations = gAllocations - before;
+        
+        JSON_THROW_IF(doc.str() != heap.str(), JSON::Exception("arena document differs from heap document."));
+        JSON_THROW_IF(2 * arenaAllocations > heapAllocations, JSON::Exception("arena load made %zu allocations, "
+                                                                              "heap load %zu.", arenaAllocations,
+                                                                              heapAllocations));
+        copy = doc;
+    }
+    
+    JSON_THROW_IF(copy.str() != heap.str(), JSON::Exception("copy out of the arena differs from heap document."));
+}
+
+//! @brief Parses in place and checks plain keys and strings view the buffer, escaped
+//! ones are decoded, copies are independent and fewer allocations are made.
+static void checkInSitu()
+{
+    std::string content = "{ \"plain\": \"text\", \"esc\\\"aped\": \"a\\nb\\u00e9\\ud83d\\ude00\", "
+                          "\"empty\": {}, \"none\": [], \"list\": [\"x\", \"y\"] }";
+
+    std::size_t before = gAllocations;
+    JSON copied = JSON::loadContent(content);
+    std::size_t copyAllocations = gAllocations - before;
+
+    before = gAllocations;
+    JSON doc = JSON::loadContent(content, JSON::S_IN_SITU);
+    std::size_t inSituAllocations = gAllocations - before;
+
+    const char* begin = content.data(), *end = begin + content.size();
+    std::string_view text = doc.value("plain").toStringView();
+    JSON_THROW_IF(text != "text" || text.data() < begin || text.data() >= end,
+                  JSON::Exception("plain string does not view the content."));
+    JSON_THROW_IF(doc.value("plain").name().data() < begin || doc.value("plain").name().data() >= end,
+                  JSON::Exception("plain key does not view the content."));
+    
+    // Reading a const document leaves it unchanged, so threads may read it together.
+    JSON_THROW_IF(std::as_const(doc).value("plain").toString() != "text" || doc.value("plain").toStringView().data() != text.data(),
+                  JSON::Exception("a const read copied the viewed string into the value."));
+    JSON_THROW_IF(doc.value("esc\"aped").toStringView() != "a\nb\xC3\xA9\xF0\x9F\x98\x80",
+                  JSON::Exception("escapes were not decoded."));
+    JSON_THROW_IF(doc.str() != copied.str(), JSON::Exception("in-situ document differs from copied document."));
+    JSON_THROW_IF(inSituAllocations >= copyAllocations, JSON::Exception("in-situ load made %zu allocations, "
+                                                                        "copying load %zu.", inSituAllocations,
+                                                                        copyAllocations));
+
+    JSON copy = doc;
+    content.assign(content.size(), ' ');
+    JSON_THROW_IF(copy.str() != copied.str(), JSON::Exception("copy of in-situ document is not independent."));
+    JSON_THROW_IF(copy.value("list").toArray().size() != 2, JSON::Exception("array was not parsed."));
+}
+
+//! @brief Loads the file through a mapping, and through a pipe where available, and
+//! checks both match the parsed content of the file.
+static void checkLoad(const std::string& file)
+{
+    std::ifstream stream(file.data(), std::ios::in | std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    std::string expected = JSON::loadContent(content).str();
+    
+    JSON_THROW_IF(JSON::load(file).str() != expected, JSON::Exception("mapped load differs from content."));
+    
+#if defined(__linux__)
+    int fds[2];
+    JSON_THROW_IF(pipe(fds) != 0, JSON::Exception("cannot create pipe."));
+    
+    // The pipe buffer holds the whole file, so it can be written before being read.
+    bool written = content.size() <= 65536 && write(fds[1], content.data(), content.size()) == (ssize_t)content.size();
+    close(fds[1]);
+    
+    JSON piped = written ? JSON::load("/dev/fd/" + std::to_string(fds[0])) : JSON::loadContent(content);
+    close(fds[0]);
+    
+    JSON_THROW_IF(piped.str() != expected, JSON::Exception("piped load differs from content."));
+#endif
+}
+
+//! @brief Parses an indented document with long strings and checks it matches its compact
+//! form, and that an error after it is reported at the right line and column.
+static void checkScanning()
+{
+    std::string indented = "{\r\n", compact = "{";
+    std::string text(70, 'x');
+    
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        indented += std::string(i * 7, ' ') + "\t\"k" + std::to_string(i) + "\" :  \"" + text + "\",\n";
+        compact += "\"k" + std::to_string(i) + "\":\"" + text + "\",";
+    }
+    
+    JSON_THROW_IF(JSON::loadContent(indented + "\"end\": true\n}").str() != JSON::loadContent(compact + "\"end\":true}").str(),
+                  JSON::Exception("indented document differs from compact document."));
+    
+    std::string expected = "Parser(11:44): unexpected character @.";
+    
+    try
+    {
+        JSON::loadContent(indented + std::string(37, ' ') + "\"bad\": @ }");
+    }
+    
+    catch(const JSON::Exception& e)
+    {
+        JSON_THROW_IF(e.what() != expected, JSON::Exception("expected '%s', got '%s'.", expected.data(), e.what()));
+        return;
+    }
+    
+    JSON_THROW(JSON::Exception("invalid document was parsed."));
+}
+
+//! @brief Returns true if the function throws a JSON::Exception.
+template < typename Function > static bool isRejectedBy(Function function)
+{
+    try
+    {
+        function();
+    }
+    
+    catch(const JSON::Exception&)
+    {
+        return true;
+    }
+    
+    return false;
+}
+
+//! @brief Returns true if the content cannot be parsed.
+static bool isRejected(const std::string& content)
+{
+    try
+    {
+        JSON::loadContent(content);
+    }
+    
+    catch(const JSON::Exception&)
+    {
+        return true;
+    }
+    
+    return false;
+}
+
+//! @brief Parses numbers of every form and checks they are stored exactly when integers.
+static void checkNumbers()
+{
+    JSON doc = JSON::loadContent("{ \"id\": 9007199254740993, \"max\": 18446744073709551615, "
+                                 "\"min\": -9223372036854775808, \"pi\": 3.141592653589793, \"exp\": 1.5e3, "
+                                 "\"negExp\": -2E-2, \"huge\": 1e400, \"tiny\": 1e-400, "
+                                 "\"over\": 18446744073709551616, \"list\": [1,2.5,-3], \"last\": 7}");
+    
+    JSON_THROW_IF(!doc["id"].isInteger() || doc["id"].toInt64() != 9007199254740993LL,
+                  JSON::Exception("integer above 2^53 lost precision."));
+    JSON_THROW_IF(doc["max"].toUInt64() != UINT64_MAX, JSON::Exception("max uint64 lost precision."));
+    JSON_THROW_IF(doc["min"].toInt64() != INT64_MIN, JSON::Exception("min int64 lost precision."));
+    JSON_THROW_IF(doc["pi"].isInteger() || doc["pi"].toDouble() != 3.141592653589793,
+                  JSON::Exception("double lost precision."));
+    JSON_THROW_IF(doc["exp"].toDouble() != 1500.0 || doc["negExp"].toDouble() != -0.02,
+                  JSON::Exception("exponent was not parsed."));
+    JSON_THROW_IF(doc["huge"].toDouble() != HUGE_VAL || doc["tiny"].toDouble() != 0.0,
+                  JSON::Exception("out of range number was not rounded."));
+    JSON_THROW_IF(doc["over"].isInteger() || doc["over"].toDouble() != 18446744073709551616.0,
+                  JSON::Exception("integer above 2^64 did not fall back to a double."));
+    JSON_THROW_IF(doc["list"].at(2).toInt64() != -3 || doc["list"].at(1).toDouble() != 2.5,
+                  JSON::Exception("numbers before ',' or ']' were not parsed."));
+    JSON_THROW_IF(doc["last"].toInt64() != 7, JSON::Exception("number before '}' was not parsed."));
+    
+    bool outOfRange = false;
+    try { doc["min"].toUInt64(); } catch(const JSON::Exception&) { outOfRange = true; }
+    JSON_THROW_IF(!outOfRange, JSON::Exception("negative integer converted to unsigned."));
+    
+    JSON_THROW_IF(!isRejected("{ \"a\": 01 }") || !isRejected("{ \"a\": 1. }") || !isRejected("{ \"a\": - }") ||
+                  !isRejected("{ \"a\": 1e }") || !isRejected("{ \"a\": .5 }"),
+                  JSON::Exception("invalid number was parsed."));
+}
+
+//! @brief Writes every event it receives in a compact form.
+struct EventRecorder : public JSON::Handler
+{
+    std::string events;
+    
+    void startObject() override { events += "{"; }
+    void endObject() override { events += "}"; }
+    void startArray() override { events += "["; }
+    void endArray() override { events += "]"; }
+    void key(std::string_view name) override { events += "k:" + std::string(name) + " "; }
+    void string(std::string_view value) override { events += "s:" + std::string(value) + " "; }
+    void number(double value) override { events += "d:" + std::to_string(value) + " "; }
+    void integer(std::int64_t value) override { events += "i:" + std::to_string(value) + " "; }
+    void boolean(bool value) override { events += value ? "true " : "false "; }
+    void null() override { events += "null "; }
+};
+
+//! @brief Sums the "size" members of the records.
+struct SizeCounter : public JSON::Handler
+{
+    bool isSize = false;
+    std::int64_t total = 0;
+    std::size_t records = 0;
+    
+    void key(std::string_view name) override { isSize = name == "size"; }
+    void integer(std::int64_t value) override { if (isSize) total += value; }
+    void endObject() override { ++records; }
+};
+
+//! @brief Checks the events sent for a document, and that streaming over many records
+//! costs a constant number of allocations.
+static void checkEvents()
+{
+    EventRecorder recorder;
+    JSON::parse(" {\"a\": [1, -2.5, \"x\\ty\", true, null, {}], \"b\": {\"c\": false}} ", recorder);
+    
+    std::string expected = "{k:a [i:1 d:-2.500000 s:x\ty true null {}]k:b {k:c false }}";
+    JSON_THROW_IF(recorder.events != expected, JSON::Exception("expected events '%s', got '%s'.",
+                                                               expected.data(), recorder.events.data()));
+    
+    std::string content = "[";
+    
+    for (unsigned i = 0; i < 10000; ++i)
+        content += std::string(i ? "," : "") + "{\"name\": \"record" + std::to_string(i) + "\", \"size\": " +
+                   std::to_string(i) + "}";
+    
+    content += "]";
+    
+    SizeCounter counter;
+    std::size_t before = gAllocations;
+    JSON::parse(content, counter);
+    std::size_t allocations = gAllocations - before;
+    
+    JSON_THROW_IF(counter.records != 10000 || counter.total != 49995000, JSON::Exception("records were not all read."));
+    JSON_THROW_IF(allocations > 4, JSON::Exception("parsing events made %zu allocations.", allocations));
+    
+    JSON withNull = JSON::loadContent("{ \"a\": null, \"b\": 1 }");
+    JSON_THROW_IF(std::distance(withNull.begin(), withNull.end()) != 2 || !withNull.begin()->isNull(),
+                  JSON::Exception("null was not parsed."));
+    
+    bool rejected = false;
+    try { JSON::parse("{} }", recorder); } catch(const JSON::Exception&) { rejected = true; }
+    JSON_THROW_IF(!rejected, JSON::Exception("content after the document was accepted."));
+    
+    // Trailing commas are rejected by every entry point, like parseInto() does.
+    for (const char* invalid : { "{\"a\": [1, 2,], }", "{\"a\": 1,}", "{\"a\": [1,]}", "{,}", "{\"a\": [,]}" })
+    {
+        JSON_THROW_IF(!isRejectedBy([invalid] { JSON::loadContent(invalid); }) ||
+                      !isRejectedBy([invalid] { EventRecorder events; JSON::parse(invalid, events); }),
+                      JSON::Exception("%s was accepted.", invalid));
+    }
+    
+    JSON_THROW_IF(!isRejectedBy([] { JSON::loadArrayContent("[1, 2,]"); }) || JSON::loadArrayContent("[]").size() != 0,
+                  JSON::Exception("trailing comma in an array was accepted."));
+}
+
+//! @brief Feeds the content in chunks of every size up to 17 bytes and checks the events
+//! match the ones of JSON::parse(), whatever token is split between two chunks.
+static void checkPushParser()
+{
+    std::string content = "{\"key\\u00e9\": [12345, -0.5e-3, \"a\\\"b\\ud83d\\ude00c\", true, false, null, {}, []],"
+                          "\n  \"long string without escape\": \"" + std::string(40, 'z') + "\", \"n\": 18446744073709551615}";
+    
+    EventRecorder expected;
+    JSON::parse(content, expected);
+    
+    for (std::size_t chunk = 1; chunk <= 17; ++chunk)
+    {
+        EventRecorder recorder;
+        JSON::PushParser parser(recorder);
+        
+        for (std::size_t pos = 0; pos < content.size(); pos += chunk)
+            parser.feed(content.data() + pos, std::min(chunk, content.size() - pos));
+        
+        parser.finish();
+        JSON_THROW_IF(recorder.events != expected.events, JSON::Exception("chunks of %zu bytes gave '%s'.",
+                                                                          chunk, recorder.events.data()));
+    }
+    
+    // A stream of values, ending with a number only complete at the end of the input.
+    EventRecorder recorder;
+    JSON::PushParser parser(recorder);
+    std::string stream = "{\"a\": 1}\n{\"a\": 2}\n[3] 4";
+    parser.feed(stream.data(), stream.size());
+    JSON_THROW_IF(recorder.events != "{k:a i:1 }{k:a i:2 }[i:3 ]", JSON::Exception("stream events were not sent early."));
+    parser.finish();
+    JSON_THROW_IF(recorder.events != "{k:a i:1 }{k:a i:2 }[i:3 ]i:4 ", JSON::Exception("last number was not sent."));
+    
+    bool rejected = false;
+    parser.feed("{\"a\": [1", 8);
+    try { parser.finish(); } catch(const JSON::Exception&) { rejected = true; }
+    JSON_THROW_IF(!rejected, JSON::Exception("incomplete input was accepted."));
+    
+    rejected = false;
+    JSON::PushParser mismatched(recorder);
+    try { mismatched.feed("[1}", 3); } catch(const JSON::Exception&) { rejected = true; }
+    JSON_THROW_IF(!rejected, JSON::Exception("mismatched brackets were accepted."));
+    
+    // Anything but a comma or the matching bracket after an element is an error, and so is
+    // a bracket after a comma.
+    for (const char* invalid : { "[1x", "[1 2", "[\"a\" 2]", "{\"a\": 1 x}", "[1,]", "{\"a\": 1,}" })
+    {
+        rejected = false;
+        JSON::PushParser garbled(recorder);
+        try { garbled.feed(invalid, std::strlen(invalid)); garbled.finish(); } catch(const JSON::Exception&) { rejected = true; }
+        JSON_THROW_IF(!rejected, JSON::Exception("%s was accepted.", invalid));
+    }
+}
+
+//! @brief Reads a few values of the file through a lazy document and checks them against
+//! the loaded document, then checks values of every type and malformed contents.
+static void checkLazy(const std::string& file)
+{
+    std::ifstream stream(file.data(), std::ios::in | std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    JSON heap = JSON::loadContent(content);
+    
+    std::size_t before = gAllocations;
+    JSON::LazyDocument lazy(content);
+    JSON::LazyValue target = lazy["Project"]["Targets"]["AtlPixellizer"];
+    std::string name = lazy["Project"]["Name"].toString();
+    std::size_t allocations = gAllocations - before;
+    
+    JSON_THROW_IF(name != heap["Project"]["Name"].toString(), JSON::Exception("lazy string differs."));
+    JSON_THROW_IF(target["PlatformSupported"].size() != 3 || target["PlatformSupported"].at(2).toString() != "Macos",
+                  JSON::Exception("lazy array differs."));
+    JSON_THROW_IF(lazy["Project"]["Dependencies"].toValue().toObject().str() != heap["Project"]["Dependencies"].toObject().str(),
+                  JSON::Exception("lazy object differs."));
+    JSON_THROW_IF(lazy["Project"].size() != 7 || !lazy["Project"]["Nope"]["Nope"].isNull(),
+                  JSON::Exception("lazy lookups differ."));
+    JSON_THROW_IF(allocations > 4, JSON::Exception("lazy reads made %zu allocations.", allocations));
+    
+    std::string types = "{\"k\\u00e9y\": \"v\\\"\", \"n\": [1, 2.5, -3 ], \"t\": true, \"z\": null, "
+                        "\"e\": [], \"o\": {}, \"bad\": 12x}";
+    JSON::LazyDocument doc(types);
+    
+    JSON_THROW_IF(doc["k\xC3\xA9y"].toString() != "v\"", JSON::Exception("escaped key or string was not decoded."));
+    JSON_THROW_IF(doc["n"].size() != 3 || doc["n"].at(0).toInt64() != 1 || doc["n"].at(1).toDouble() != 2.5 ||
+                  doc["n"].at(2).toInt64() != -3 || !doc["n"].at(3).isNull(), JSON::Exception("lazy numbers differ."));
+    JSON_THROW_IF(!doc["t"].toBoolean() || !doc["z"].isNull() || doc["z"].isBoolean(),
+                  JSON::Exception("lazy literals differ."));
+    JSON_THROW_IF(doc["e"].size() != 0 || !doc["e"].at(0).isNull() || doc["o"].size() != 0 || doc.root().size() != 7,
+                  JSON::Exception("lazy sizes differ."));
+    JSON_THROW_IF(!isRejectedBy([&] { doc["bad"].toInt64(); }), JSON::Exception("lazy number was not checked."));
+    JSON_THROW_IF(!isRejectedBy([] { JSON::LazyDocument("{\"a\": [1}"); }) ||
+                  !isRejectedBy([] { JSON::LazyDocument("{\"a\": \"x}"); }) ||
+                  !isRejectedBy([] { JSON::LazyDocument("{\"a\": [1]"); }),
+                  JSON::Exception("malformed structure was indexed."));
+}
+
+//! @brief Writes a document in both layouts, to a buffer, a stream and a pipe, and checks
+//! the output parses back to the same document.
+static void checkRoundTrip()
+{
+    // Doubles are written in their shortest form, and parse back to the same bits.
+    const double numbers[] = { 0.1, 1.0 / 3.0, 3.141592653589793, 1e300, 5e-324, 2.2250738585072014e-308,
+                               -1.7976931348623157e308, 123456.789, 1e21, -0.0 };
+    
+    for (double number : numbers)
+    {
+        JSON doc;
+        doc["n"] = number;
+        
+        JSON::Writer writer(JSON::Writer::L_COMPACT);
+        writer.write(doc);
+        
+        double parsed = JSON::loadContent(writer.content())["n"].toDouble();
+        JSON_THROW_IF(std::memcmp(&parsed, &number, sizeof(double)) != 0,
+                      JSON::Exception("%.17g written as '%s' parses back as %.17g.", number,
+                                      std::string(writer.content()).data(), parsed));
+    }
+    
+    struct Expected { double number; const char* text; };
+    const Expected expected[] = { { 1500.0, "{\"n\":1500}" }, { 0.1, "{\"n\":0.1}" }, { -2.0, "{\"n\":-2}" },
+                                  { 1e300, "{\"n\":1e+300}" }, { HUGE_VAL, "{\"n\":null}" } };
+    
+    for (const Expected& e : expected)
+    {
+        JSON doc;
+        doc["n"] = e.number;
+        
+        JSON::Writer writer(JSON::Writer::L_COMPACT);
+        writer.write(doc);
+        JSON_THROW_IF(writer.content() != e.text, JSON::Exception("%g is written as '%s'.", e.number,
+                                                                  std::string(writer.content()).data()));
+    }
+}
+
+//! @brief Serializes structures declaring JSON_FIELDS straight as text, and checks the output
+//! matches the one of the same document written from its nodes, without allocating.
+static void checkSerialize()
+{
+    Shape shape{ { { 1, 0.5, "a\"b" }, { -2, 3, "" } }, { { "k", 18446744073709551615ull } }, std::nullopt, { 26, "x" } };
+    
+    JSON::Writer compact(JSON::Writer::L_COMPACT);
+    compact.serialize(shape);
+    
+    std::string expected = "{\"points\":[{\"x\":1,\"y\":0.5,\"label\":\"a\\\"b\"},{\"x\":-2,\"y\":3,\"label\":\"\"}],"
+                           "\"tags\":{\"k\":18446744073709551615},\"hidden\":null,\"legacy\":{\"a\":26,\"b\":\"x\"}}";
+    JSON_THROW_IF(compact.content() != expected, JSON::Exception("serialized as '%s'.", std::string(compact.content()).data()));
+    
+    // The pretty layout is the one of the same document written from its nodes.
+    JSON::Writer pretty(JSON::Writer::L_PRETTY, "  "), nodes(JSON::Writer::L_PRETTY, "  ");
+    pretty.serialize(shape);
+    nodes.write(JSON::loadContent(expected));
+    JSON_THROW_IF(pretty.content() != nodes.content(), JSON::Exception("pretty serialization is '%s'.",
+                                                                       std::string(pretty.content()).data()));
+    
+    // Structures are written without a node: writing again into the cleared buffer allocates nothing.
+    std::vector < Point > points(1000, Point{ 7, 1.25, "point" });
+    compact.clear();
+    compact.serialize(points);
+    compact.clear();
+    
+    std::size_t before = gAllocations;
+    compact.serialize(points);
+    JSON_THROW_IF(gAllocations != before, JSON::Exception("serializing made %zu allocations.", gAllocations - before));
+    JSON_THROW_IF(JSON::loadArrayContent(compact.content(), 1).size() != 1000, JSON::Exception("serialized points do not parse."));
+}
+
+//! @brief Returns the error message parsing the content into a T gives, or an empty string.
+template < typename T > static std::string parseIntoError(const std::string& content)
+{
+    try
+    {
+        T value;
+        JSON::parseInto(content, value);
+    }
+    
+    catch(const JSON::Exception& e)
+    {
+        return e.what();
+    }
+    
+    return std::string();
+}
+
+//! @brief Parses text straight into structures declaring JSON_FIELDS, and checks unknown members
+//! are skipped, fields are filled and invalid contents or declarations are rejected.
+static void checkParseInto()
+{
+    std::string content = "{\"unknown\": {\"a\": [1, \"\\\"]}\", {\"b\": null}]}, \"points\": [{\"label\": \"a\\\"b\", "
+                          "\"x\": 1, \"skipped\": [true, false], \"y\": 0.5}, {\"x\": -2, \"y\": 3, \"label\": \"\"}],"
+                          " \"tags\": {\"k\": 18446744073709551615}, \"hidden\": null, \"legacy\": {\"a\": 26, \"b\": \"x\"}}";
+    
+    // Fields declared twice could never be told apart.
+    JSON_THROW_IF(!isRejectedBy([] { Twice twice; JSON::parseInto("{\"x\": 1}", twice); }),
+                  JSON::Exception("a field declared twice was accepted."));
+    
+    Shape shape;
+    shape.hidden = true;
+    JSON::parseInto(content, shape);
+    
+    JSON_THROW_IF(shape.points.size() != 2 || shape.points[0].x != 1 || shape.points[0].y != 0.5 ||
+                  shape.points[0].label != "a\"b" || shape.points[1].x != -2 || shape.points[1].label != "",
+                  JSON::Exception("points are parsed wrong."));
+    JSON_THROW_IF(shape.tags.size() != 1 || shape.tags["k"] != 18446744073709551615ull || shape.hidden.has_value() ||
+                  shape.legacy.a != 26 || shape.legacy.b != "x", JSON::Exception("shape is parsed wrong."));
+    
+    // Parsing back the serialized structure gives the same one.
+    JSON::Writer first(JSON::Writer::L_COMPACT), second(JSON::Writer::L_COMPACT);
+    first.serialize(shape);
+    
+    Shape parsed;
+    JSON::parseInto(first.content(), parsed);
+    second.serialize(parsed);
+    JSON_THROW_IF(first.content() != second.content(), JSON::Exception("round trip gives '%s'.",
+                                                                       std::string(second.content()).data()));
+    
+    // Only the cursor itself is allocated: unknown members are skipped without allocating.
+    Point point;
+    std::size_t before = gAllocations;
+    JSON::parseInto("{\"x\": 1, \"unknown\": {\"a\": [1, 2.5, {\"b\": \"c\"}]}, \"y\": 2.5, \"label\": \"short\"}", point);
+    JSON_THROW_IF(gAllocations - before > 1, JSON::Exception("parsing a point made %zu allocations.", gAllocations - before));
+    JSON_THROW_IF(point.x != 1 || point.y != 2.5 || point.label != "short", JSON::Exception("point is parsed wrong."));
+    
+    JSON_THROW_IF(parseIntoError < Point >("{\"x\": 3000000000}").find("out of range") == std::string::npos,
+                  JSON::Exception("an integer out of range is accepted."));
+    JSON_THROW_IF(parseIntoError < Point >("{\"x\": 1.5}").find("expected an integer") == std::string::npos,
+                  JSON::Exception("a fraction is accepted for an integer."));
+    JSON_THROW_IF(parseIntoError < Point >("{\"x\": 1 \"y\": 2}").empty(), JSON::Exception("a missing comma is accepted."));
+    JSON_THROW_IF(parseIntoError < Point >("{\"x\": 1,}").empty(), JSON::Exception("a trailing comma is accepted."));
+    JSON_THROW_IF(parseIntoError < Point >("{\"x\": 1} {").empty(), JSON::Exception("content after the value is accepted."));
+    JSON_THROW_IF(parseIntoError < std::vector < Point > >("[{\"label\": 2}]").empty(), JSON::Exception("a number is accepted for a string."));
+}
+
+//! @brief Loads JSON Lines serially and in parallel, and checks records keep the order of their
+//! lines, are sent in order to a callback, and an invalid line is reported at its line.
+static void checkLines()
+{
+    // Enough lines for the content to be split in several chunks, with blank and CRLF lines.
+    std::string content;
+    
+    for (int i = 0; i < 20000; ++i)
+    {
+        content += "{\"id\": " + std::to_string(i) + ", \"name\": \"record " + std::to_string(i) + "\"}";
+        content += i % 7 == 0 ? "\r\n" : i % 11 == 0 ? "\n\n  \n" : "\n";
+    }
+    
+    for (unsigned threads : { 1u, 4u, 0u })
+    {
+        std::vector < JSON > records = JSON::loadLinesContent(content, threads);
+        JSON_THROW_IF(records.size() != 20000, JSON::Exception("loaded %zu records.", records.size()));
+        
+        for (std::size_t i = 0; i < records.size(); ++i)
+            JSON_THROW_IF(records[i]["id"].toInt64() != static_cast < std::int64_t >(i),
+                          JSON::Exception("record %zu is out of order.", i));
+    }
+    
+    std::int64_t expected = 0;
+    JSON::loadLinesContent(content, [&expected](JSON&& record)
+    {
+        JSON_THROW_IF(record["id"].toInt64() != expected, JSON::Exception("record %lli is sent out of order.",
+                                                                         static_cast < long long >(expected)));
+        expected = expected + 1;
+    }, 4);
+    JSON_THROW_IF(expected != 20000, JSON::Exception("sent %lli records.", static_cast < long long >(expected)));
+    
+    // An invalid line is reported with its line in the whole content, and the records before it are sent.
+    std::string invalid = content.substr(0, content.find("{\"id\": 15000,")) + "{\"id\": 15000} trailing\n" + content;
+    std::size_t line = std::count(invalid.begin(), invalid.begin() + invalid.find("trailing"), '\n');
+    std::size_t sent = 0;
+    
+    try
+    {
+        JSON::loadLinesContent(invalid, [&sent](JSON&&) { sent = sent + 1; }, 4);
+        JSON_THROW(JSON::Exception("an invalid line is accepted."));
+    }
+    
+    catch(const JSON::Exception& e)
+    {
+        std::string prefix = "Parser(" + std::to_string(line) + ":";
+        JSON_THROW_IF(std::string(e.what()).compare(0, prefix.size(), prefix) != 0,
+                      JSON::Exception("invalid line reported as '%s' instead of line %zu.", e.what(), line));
+    }
+    
+    JSON_THROW_IF(sent != 15000, JSON::Exception("sent %zu records before the invalid line.", sent));
+    JSON_THROW_IF(!JSON::loadLinesContent("").empty() || !JSON::loadLinesContent("\n \n").empty(),
+                  JSON::Exception("blank content holds records."));
+}
+
+//! @brief Returns the error message loading the array gives, or an empty string.
+static std::string arrayError(const std::string& content, unsigned threads)
+{
+    try
+    {
+        JSON::loadArrayContent(content, threads);
+    }
+    
+    catch(const JSON::Exception& e)
+    {
+        return e.what();
+    }
+    
+    return std::string();
+}
+
+//! @brief Loads top-level arrays serially and in parallel, and checks both give the same elements
+//! and the same errors, whatever commas strings and nested arrays hold.
+static void checkArrays()
+{
+    JSON::Array small = JSON::loadArrayContent(" [1, \"two\", {\"a\": [3]}] ");
+    JSON_THROW_IF(small.size() != 3 || small[1].toString() != "two" || small[2].toObject()["a"].toArray().size() != 1,
+                  JSON::Exception("small array loaded wrong."));
+    JSON_THROW_IF(arrayError("[1, 2] 3", 0).empty(), JSON::Exception("content after the array is accepted."));
+    
+    // Elements have no names, so numbers are stored in the array and nowhere else.
+    std::string numbers = "[0";
+    
+    for (int i = 1; i < 10000; ++i)
+        numbers += "," + std::to_string(i);
+    
+    numbers += "]";
+    std::size_t before = gAllocations;
+    JSON::Array parsed = JSON::loadArrayContent(numbers, 1);
+    
+    JSON_THROW_IF(gAllocations - before > 64 || parsed[9999].toInt64() != 9999 || !parsed[9999].name().empty() ||
+                  !small[2].toObject()["a"].toArray()[0].name().empty(),
+                  JSON::Exception("array elements are named, %zu allocations.", gAllocations - before));
+    
+    // Strings and nested arrays hold commas looking like the ones between elements.
+    for (const char* separator : { ",\n", ", ", "," })
+    {
+        std::string content = "[";
+        
+        for (int i = 0; i < 8000; ++i)
+        {
+            if (i)
+                content += separator;
+            
+            content += "{\"id\": " + std::to_string(i) + ", \"text\": \"a}, {\\\"b\\\": [1, 2]}, {\", "
+                       "\"items\": [{\"x\": 1}, {\"y\": \"\\u0041,\"}]}";
+        }
+        
+        content += "]\n";
+        
+        JSON::Array serial = JSON::loadArrayContent(content, 1);
+        JSON::Array parallel = JSON::loadArrayContent(content, 4);
+        
+        JSON_THROW_IF(parallel.size() != 8000, JSON::Exception("loaded %zu elements.", parallel.size()));
+        JSON_THROW_IF(JSON::Value("", parallel).str() != JSON::Value("", serial).str(),
+                      JSON::Exception("parallel and serial loads differ."));
+        
+        for (std::size_t i = 0; i < parallel.size(); ++i)
+            JSON_THROW_IF(!parallel[i].name().empty() || parallel[i].toObject()["id"].toInt64() != (std::int64_t)i,
+                          JSON::Exception("element %zu is out of place.", i));
+        
+        // An error is reported at the same place as a serial load would.
+        std::string invalid = content;
+        invalid.replace(invalid.find("{\"id\": 6000,"), 1, "{,");
+        
+        std::string expected = arrayError(invalid, 1);
+        JSON_THROW_IF(expected.empty() || arrayError(invalid, 4) != expected,
+                      JSON::Exception("parallel error '%s' instead of '%s'.", arrayError(invalid, 4).data(), expected.data()));
+    }
+}
+
+//! @brief Returns the bytes as a string.
+static std::string bytes(std::initializer_list < unsigned > list)
+{
+    std::string result;
+    
+    for (unsigned byte : list)
+        result.push_back(static_cast < char >(byte));
+    
+    return result;
+}
+
+//! @brief Writes documents as CBOR and MessagePack and reads them back, whole and in chunks.
+static void checkBinary()
+{
+    JSON doc = JSON::loadContent("{\"s\": \"héllo\", \"long\": \"" + std::string(300, 'x') + "\", \"n\": [0, 23, 24, -1, -24, "
+                                 "-25, 127, 128, -32, -33, 65535, 65536, -129, 4294967296, -9223372036854775808, "
+                                 "18446744073709551615, 0.5, 0.1, -2.5e300], \"o\": {\"e\": {}, \"a\": [], \"t\": true, "
+                                 "\"f\": false, \"z\": null}}");
+    
+    for (JSON::BinaryFormat format : { JSON::B_CBOR, JSON::B_MESSAGEPACK })
+    {
+        std::string data = format == JSON::B_CBOR ? doc.toCBOR() : doc.toMessagePack();
+        JSON read = format == JSON::B_CBOR ? JSON::fromCBOR(data) : JSON::fromMessagePack(data);
+        
+        JSON_THROW_IF(read.str() != doc.str(), JSON::Exception("format %i reads back as %s.", format, read.str().data()));
+        JSON_THROW_IF(read["n"].toArray()[14].toInt64() != INT64_MIN || read["n"].toArray()[15].toUInt64() != UINT64_MAX,
+                      JSON::Exception("format %i lost the extreme integers.", format));
+        
+        // Documents written in a row are read back in turn, whole or from chunks of any size.
+        std::ostringstream stream;
+        
+        {
+            JSON::BinaryWriter writer(stream, format);
+            writer.write(doc).write(read["o"].toObject());
+        }
+        
+        EventRecorder expected;
+        JSON::parse(doc.str(), expected);
+        JSON::parse(read["o"].toObject().str(), expected);
+        
+        std::string input = stream.str();
+        JSON::BinaryReader reader(input, format);
+        JSON_THROW_IF(reader.read().str() != doc.str() || reader.read().str() != read["o"].toObject().str() ||
+                      !reader.atEnd(), JSON::Exception("format %i stream reads back wrong.", format));
+        
+        for (std::size_t chunk = 1; chunk <= 9; ++chunk)
+        {
+            EventRecorder recorder;
+            JSON::BinaryPushParser parser(recorder, format);
+            
+            for (std::size_t pos = 0; pos < input.size(); pos += chunk)
+                parser.feed(input.data() + pos, std::min(chunk, input.size() - pos));
+            
+            parser.finish();
+            JSON_THROW_IF(recorder.events != expected.events, JSON::Exception("format %i in chunks of %zu bytes gave '%s'.",
+                                                                              format, chunk, recorder.events.data()));
+        }
+        
+        JSON_THROW_IF(!isRejectedBy([&] { JSON::BinaryReader(data.substr(0, data.size() - 1), format).read(); }) ||
+                      !isRejectedBy([&] { JSON::BinaryPushParser parser(expected, format);
+                                          parser.feed(data.data(), data.size() - 1); parser.finish(); }),
+                      JSON::Exception("format %i accepted a truncated document.", format));
+    }
+    
+    // Known encodings: integers and floats take their smallest exact form.
+    JSON small = JSON::loadContent("{\"a\": -1, \"b\": 0.5, \"c\": 500}");
+    JSON_THROW_IF(small.toCBOR() != bytes({ 0xA3, 0x61, 'a', 0x20, 0x61, 'b', 0xFA, 0x3F, 0, 0, 0, 0x61, 'c', 0x19, 0x01, 0xF4 }),
+                  JSON::Exception("unexpected CBOR encoding."));
+    JSON_THROW_IF(small.toMessagePack() != bytes({ 0x83, 0xA1, 'a', 0xFF, 0xA1, 'b', 0xCA, 0x3F, 0, 0, 0, 0xA1, 'c', 0xCD, 0x01, 0xF4 }),
+                  JSON::Exception("unexpected MessagePack encoding."));
+    
+    // CBOR of indefinite lengths, half floats and tags, as other encoders write them.
+    JSON indefinite = JSON::fromCBOR(bytes({ 0xBF, 0x61, 'a', 0x9F, 0x01, 0xF9, 0x3C, 0x00, 0xFF,
+                                             0x7F, 0x61, 'k', 0x62, 'e', 'y', 0xFF, 0xC1, 0x18, 0x64, 0xFF }));
+    JSON_THROW_IF(indefinite["a"].toArray()[1].toDouble() != 1.0 || indefinite["key"].toInt64() != 100,
+                  JSON::Exception("indefinite CBOR reads as %s.", indefinite.str().data()));
+    
+    JSON_THROW_IF(!isRejectedBy([] { JSON::fromCBOR(bytes({ 0xA1, 0x01, 0x02 })); }) ||
+                  !isRejectedBy([] { JSON::fromMessagePack(bytes({ 0x81, 0xA1, 'a', 0xC1 })); }) ||
+                  !isRejectedBy([] { JSON::fromCBOR(bytes({ 0xA0, 0xA0 })); }) ||
+                  !isRejectedBy([] { JSON::fromCBOR(bytes({ 0x9B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF })); }),
+                  JSON::Exception("invalid binary documents were accepted."));
+    
+    // Empty keys are rejected, like the text parser does.
+    JSON_THROW_IF(!isRejectedBy([] { JSON::fromCBOR(bytes({ 0xA1, 0x60, 0x01 })); }) ||
+                  !isRejectedBy([] { JSON::fromMessagePack(bytes({ 0x81, 0xA0, 0x01 })); }) ||
+                  !isRejectedBy([] { EventRecorder events; JSON::BinaryReader(bytes({ 0xA1, 0x60, 0x01 }), JSON::B_CBOR).read(events); }),
+                  JSON::Exception("empty binary keys were accepted."));
+}
+
+//! @brief Writes a document as an image and reads it back in place, from memory and from a file.
+static void checkImage()
+{
+    std::string text = "{\"s\": \"héllo\", \"n\": [0, -1, -9223372036854775808, 18446744073709551615, 0.5, -2.5e300], "
+                       "\"o\": {\"e\": {}, \"a\": [], \"t\": true, \"f\": false, \"z\": null}, \"big\": {";
+    
+    for (int i = 0; i < 100; ++i)
+        text += (i ? ", \"k" : "\"k") + std::to_string((i * 37) % 100) + "\": " + std::to_string(i);
+    
+    JSON doc = JSON::loadContent(text + "}}");
+    std::string image = doc.toImage();
+    JSON::MappedDocument mapped(image);
+    
+    JSON_THROW_IF(mapped.root().toValue().toObject().str() != doc.str(), JSON::Exception("image reads back as %s.",
+                                                                 mapped.root().toValue().toObject().str().data()));
+    JSON_THROW_IF(mapped["s"].toString() != "héllo" || mapped["n"].at(2).toInt64() != INT64_MIN ||
+                  mapped["n"].at(3).toUInt64() != UINT64_MAX || mapped["n"].at(5).toDouble() != -2.5e300 ||
+                  !mapped["o"]["t"].toBoolean() || !mapped["o"]["z"].isNull() || mapped["o"].key(1) != "a",
+                  JSON::Exception("image values read wrong."));
+    
+    // Large objects are searched by key, small ones in order.
+    for (int i = 0; i < 100; ++i)
+    {
+        JSON::MappedValue value = mapped["big"]["k" + std::to_string((i * 37) % 100)];
+        JSON_THROW_IF(!value.isNumber() || value.toInt64() != i, JSON::Exception("big[%i] reads wrong.", i));
+    }
+    
+    JSON_THROW_IF(!mapped["missing"]["deeper"].at(3).isNull() || !mapped["big"]["k100"].isNull() ||
+                  mapped["big"].size() != 100 || mapped["n"].size() != 6 || mapped["s"].size() != 0,
+                  JSON::Exception("image lookups of missing values failed."));
+    
+    JSON_THROW_IF(!isRejectedBy([&] { JSON::MappedDocument(image.substr(0, image.size() - 1)); }) ||
+                  !isRejectedBy([&] { JSON::MappedDocument(image.substr(1)); }) ||
+                  !isRejectedBy([&] { mapped["s"].toDouble(); }),
+                  JSON::Exception("invalid images or conversions were accepted."));
+    
+    // A node pointing back to its parent is rejected rather than read forever.
+    std::string looping = image;
+    std::uint64_t root = 48;
+    std::memcpy(&looping[root + 8], &root, sizeof(root));
+    JSON_THROW_IF(!isRejectedBy([&] { JSON::MappedDocument(looping).root().toValue(); }),
+                  JSON::Exception("looping image was accepted."));
+    
+    doc.saveImage("JSONPPTest.image");
+    JSON::MappedDocument opened = JSON::MappedDocument::open("JSONPPTest.image");
+    
+    // Saving over a mapped image leaves the mapping on the previous one.
+    JSON::loadContent("{\"big\": {\"k42\": 1}}").saveImage("JSONPPTest.image");
+    JSON::MappedDocument reopened = JSON::MappedDocument::open("JSONPPTest.image");
+    std::remove("JSONPPTest.image");
+    
+    JSON_THROW_IF(opened["big"]["k42"].toInt64() != 66 || opened.root().toValue().toObject().str() != doc.str(),
+                  JSON::Exception("image file reads back wrong."));
+    JSON_THROW_IF(reopened["big"]["k42"].toInt64() != 1, JSON::Exception("image file was not replaced."));
+}
+
+//! @brief Runs pointers and paths over documents, and checks misses and mismatches return null.
+static void checkPath()
+{
+    JSON doc = JSON::loadContent("{\"store\": {\"book\": [{\"title\": \"A\", \"price\": 8}, {\"title\": \"B\", \"price\": 12},"
+                                 " {\"title\": \"C\"}], \"a/b\": 1, \"m~n\": 2, \"a.b\": 3, \"0\": 4}, \"s\": \"text\"}");
+    
+    auto title = [](const JSON::Value* value) { return value ? value->toString() : std::string("(null)"); };
+    
+    JSON_THROW_IF(title(JSON::Path("/store/book/1/title").find(doc)) != "B" ||
+                  JSON::Path("/store/a~1b").find(doc)->toInt64() != 1 || JSON::Path("/store/m~0n").find(doc)->toInt64() != 2 ||
+                  JSON::Path("/store/0").find(doc)->toInt64() != 4 || JSON::Path("").find(doc) != nullptr ||
+                  JSON::Path("/store/book/-").find(doc) != nullptr || JSON::Path("/store/book/01").find(doc) != nullptr,
+                  JSON::Exception("pointers select the wrong values."));
+    
+    JSON_THROW_IF(title(JSON::Path("$.store.book[-1].title").find(doc)) != "C" ||
+                  JSON::Path("$.store['a.b']").find(doc)->toInt64() != 3 ||
+                  JSON::Path("$['store'][\"a/b\"]").find(doc)->toInt64() != 1,
+                  JSON::Exception("paths select the wrong values."));
+    
+    auto titles = [&](const char* path)
+    {
+        std::string result;
+        
+        for (const JSON::Value* value : JSON::Path(path).findAll(doc))
+            result += value->isString() ? value->toString() : "?";
+        
+        return result;
+    };
+    
+    JSON_THROW_IF(titles("$.store.book[*].title") != "ABC" || titles("$.store.book[1:].title") != "BC" ||
+                  titles("$.store.book[::2].title") != "AC" || titles("$.store.book[-2:-1].title") != "B" ||
+                  titles("$.*") != "?text" || titles("$.store.book[5:9]") != "" || titles("$.store.book[*].price").size() != 2,
+                  JSON::Exception("wildcards and slices select the wrong values."));
+    
+    // Mismatched types and misses are null, never an exception.
+    JSON_THROW_IF(JSON::Path("$.s[0]").find(doc) || JSON::Path("$.s.x").find(doc) || JSON::Path("$.missing.x[2]").find(doc) ||
+                  JSON::Path("$.store[0]").find(doc) || JSON::Path("$[0]").find(doc),
+                  JSON::Exception("mismatched paths selected values."));
+    
+    // A compiled path keeps finding members moved around in other documents, and allocates nothing.
+    JSON::Path price("$.store.book[0].price");
+    JSON other = JSON::loadContent("{\"s\": 1, \"store\": {\"x\": 0, \"book\": [{\"price\": 5}]}}");
+    std::size_t before = gAllocations;
+    
+    for (int i = 0; i < 100; ++i)
+    {
+        JSON_THROW_IF(price.find(i % 2 ? other : doc)->toInt64() != (i % 2 ? 5 : 8),
+                      JSON::Exception("compiled path lost its member."));
+    }
+    
+    JSON_THROW_IF(gAllocations != before, JSON::Exception("finding a value made %zu allocations.", gAllocations - before));
+    
+    JSON_THROW_IF(!isRejectedBy([] { JSON::Path("store"); }) || !isRejectedBy([] { JSON::Path("$.a["); }) ||
+                  !isRejectedBy([] { JSON::Path("/a~2"); }) || !isRejectedBy([] { JSON::Path("$.a[::0]"); }) ||
+                  !isRejectedBy([] { JSON::Path("$.a['b"); }),
+                  JSON::Exception("invalid paths were compiled."));
+}
+
+//! @brief Checks repeated keys share one interned copy across documents and copies, lookups find
+//! members by interned or plain keys, and keys too long are stored on their own.
+static void checkIntern()
+{
+    JSON first = JSON::loadContent("{\"id\": 1, \"tags\": [{\"id\": 2}]}");
+    JSON second = JSON::loadContent("{\"tags\": 3, \"id\": 4}");
+    
+    // Every occurrence of a key points to the same characters, whatever the document.
+    JSON_THROW_IF(first.begin()->name().data() != (second.end() - 1)->name().data() ||
+                  first["tags"].toArray()[0].toObject().begin()->name().data() != JSON::intern("id").data() ||
+                  JSON::intern("tags").data() != second.begin()->name().data(),
+                  JSON::Exception("repeated keys were not interned."));
+    
+    JSON copy = first;
+    JSON_THROW_IF(copy.begin()->name().data() != first.begin()->name().data() || copy["id"].toInt64() != 1,
+                  JSON::Exception("copies do not share interned keys."));
+    
+    // Lookups with interned or plain keys find the same members, in small and indexed objects.
+    JSON wide;
+    
+    for (int i = 0; i < 20; ++i)
+        wide[std::to_string(i)] = JSON::Number(i);
+    
+    JSON_THROW_IF(wide[JSON::intern("13")].toInt64() != 13 || wide[std::string("13")].toInt64() != 13 ||
+                  !first.value(std::string_view("idx", 2)).isNumber() || !wide.value("20").isNull(),
+                  JSON::Exception("lookups by name failed."));
+    
+    std::string longKey(JSON_INTERN_MAX + 1, 'k');
+    JSON_THROW_IF(!JSON::intern(longKey).empty() || !JSON::intern("").empty(),
+                  JSON::Exception("keys too long to intern were interned."));
+    
+    wide[longKey] = true;
+    JSON_THROW_IF(!wide[longKey].toBoolean(), JSON::Exception("long keys are not stored anymore."));
+}
+
+//! @brief Checks copies share objects, arrays and strings until one is changed, a change clones
+//! only the path to it, and copies made from several threads count their owners exactly.
+static void checkCopyOnWrite()
+{
+    std::string content = "{\"config\": {\"limits\": {\"rate\": 10, \"burst\": 20}, \"hosts\": [\"a\", \"b\"], \"items\": [";
+    
+    for (int i = 0; i < 1000; ++i)
+        content += (i ? ", " : "") + std::to_string(i);
+    
+    content += "]}}";
+    const JSON doc = JSON::loadContent(content);
+    
+    // Copying a subtree only counts one more owner.
+    std::size_t before = gAllocations;
+    JSON::Value config(doc["config"]);
+    JSON_THROW_IF(gAllocations != before || &std::as_const(config).toObject() != &doc["config"].toObject(),
+                  JSON::Exception("copying a subtree made %zu allocations.", gAllocations - before));
+    
+    // Changing a copy clones the nodes on the path to the change, and shares the others.
+    JSON copy = doc;
+    copy["config"]["limits"]["rate"] = JSON::Number(5);
+    const JSON& changed = copy;
+    
+    JSON_THROW_IF(doc["config"]["limits"]["rate"].toInt64() != 10 || changed["config"]["limits"]["rate"].toInt64() != 5 ||
+                  &changed["config"]["limits"].toObject() == &doc["config"]["limits"].toObject() ||
+                  &changed["config"]["items"].toArray() != &doc["config"]["items"].toArray() ||
+                  changed["config"]["limits"]["burst"].toInt64() != 20,
+                  JSON::Exception("changing a copy changed the original, or cloned too much."));
+    
+    // A reference taken after a copy changes its own value only.
+    JSON::Value hosts(doc["config"]["hosts"]);
+    JSON::Value other(hosts);
+    hosts.toArray()[0] = std::string("c");
+    hosts.toArray()[1].toString() += "d";
+    
+    JSON_THROW_IF(std::as_const(other).toArray()[0].toString() != "a" || doc["config"]["hosts"].toArray()[0].toString() != "a" ||
+                  std::as_const(other).toArray()[1].toString() != "b" || std::as_const(hosts).toArray()[0].toString() != "c" ||
+                  std::as_const(hosts).toArray()[1].toString() != "bd",
+                  JSON::Exception("a change through a reference leaked into a copy."));
+    
+    // Reading through non-const accessors leaves the document shared by its later copies,
+    // and copying a document, strings included, only counts one more owner.
+    JSON live = JSON::loadContent("{\"name\": \"a string too long to be stored in place\", \"config\": " + content.substr(11));
+    JSON_THROW_IF(live["config"]["limits"]["rate"].toInt64() != 10 || live["config"]["hosts"].at(0).toString() != "a" ||
+                  live["name"].toString().size() != 39, JSON::Exception("reading through non-const accessors failed."));
+    
+    before = gAllocations;
+    JSON again = live;
+    JSON::Value name(std::as_const(live)["name"]), limits(std::as_const(live)["config"]["limits"]);
+    
+    JSON_THROW_IF(gAllocations != before || &std::as_const(again)["config"]["limits"].toObject() != &std::as_const(limits).toObject() ||
+                  std::as_const(again)["name"].toStringView().data() != std::as_const(name).toStringView().data(),
+                  JSON::Exception("copying a document read through non-const accessors made %zu allocations.",
+                                  gAllocations - before));
+    
+    // Copies made from other threads count their owners exactly.
+    std::vector < std::thread > threads;
+    std::atomic < int > lost(0);
+    
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&doc, &lost]
+        {
+            for (int i = 0; i < 1000; ++i)
+            {
+                const JSON local = doc;
+                lost += local["config"]["items"].toArray().size() != 1000;
+            }
+        });
+    
+    for (std::thread& thread : threads)
+        thread.join();
+    
+    JSON_THROW_IF(lost || doc["config"]["items"].toArray()[999].toInt64() != 999,
+                  JSON::Exception("shared array lost by copies from other threads."));
+}
+
+//! @brief Checks the null value cannot be changed, and readers of an AtomicDocument see whole
+//! versions in order while another thread stores new ones, loading without allocating.
+static void checkSnapshot()
+{
+    // Missing values are null, and writing one does not make others exist.
+    JSON empty;
+    empty.value("missing") = JSON::Number(1);
+    JSON_THROW_IF(!empty.value("other").isNull() || !JSON::NullValue.isNull() || !std::as_const(empty)["x"].isNull(),
+                  JSON::Exception("the null value was changed."));
+    
+    auto version = [](int v)
+    {
+        std::string n = std::to_string(v);
+        return JSON::Snapshot(JSON::loadContent("{\"version\": " + n + ", \"data\": {\"a\": " + n + ", \"b\": [" + n + "]}}"));
+    };
+    
+    JSON::AtomicDocument config(version(0));
+    JSON::Snapshot first = config.load();
+    
+    std::size_t before = gAllocations;
+    JSON::Snapshot again = config.load();
+    JSON_THROW_IF(gAllocations != before || &*again != &*first, JSON::Exception("loading a snapshot allocated."));
+    
+    // Readers always see a whole version, never going back to an older one.
+    std::atomic < bool > done(false);
+    std::atomic < int > torn(0);
+    std::vector < std::thread > readers;
+    
+    for (int t = 0; t < 4; ++t)
+        readers.emplace_back([&]
+        {
+            std::int64_t last = 0;
+            
+            while (!done)
+            {
+                JSON::Snapshot snapshot = config.load();
+                std::int64_t current = snapshot["version"].toInt64();
+                const JSON& data = snapshot["data"].toObject();
+                
+                torn += current < last || data["a"].toInt64() != current || data["b"].toArray()[0].toInt64() != current;
+                last = current;
+            }
+        });
+    
+    for (int v = 1; v <= 200; ++v)
+        config.store(version(v));
+    
+    done = true;
+    
+    for (std::thread& reader : readers)
+        reader.join();
+    
+    JSON::Snapshot previous = config.exchange(JSON::Snapshot());
+    
+    JSON_THROW_IF(torn || previous["version"].toInt64() != 200 || first["version"].toInt64() != 0 ||
+                  !config.load()["version"].isNull(),
+                  JSON::Exception("readers saw %i torn or older snapshots.", torn.load()));
+}
+
+//! @brief Watches a file while rewriting it, and checks valid changes are published, invalid
+//! ones are counted and reported without replacing the document, and bursts are debounced.
+static void checkWatcher()
+{
+    const char* file = "JSONPPTest.watch.json";
+    auto write = [file](const std::string& content) { std::ofstream(file, std::ios::trunc) << content; };
+    
+    // Waits for the watcher to catch up, for a few seconds at most.
+    auto await = [](auto condition)
+    {
+        for (int i = 0; i < 500 && !condition(); ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        
+        return condition();
+    };
+    
+    write("{\"version\": 1}");
+    std::atomic < int > published(0);
+    
+    {
+        JSON::Watcher watcher(file, [&published](const JSON::Snapshot& snapshot) { published = (int)snapshot["version"].toInt64(); },
+                              std::chrono::milliseconds(20));
+        
+        JSON_THROW_IF(watcher.load()["version"].toInt64() != 1, JSON::Exception("watched file was not loaded."));
+        
+        write("{\"version\": 2}");
+        JSON_THROW_IF(!await([&] { return published == 2; }) || watcher.load()["version"].toInt64() != 2,
+                      JSON::Exception("changed file was not reloaded."));
+        
+        // An invalid file is reported, and the previous document is kept.
+        write("{\"version\": ");
+        JSON_THROW_IF(!await([&] { return watcher.stats().failures == 1; }) || watcher.error().empty() ||
+                      watcher.load()["version"].toInt64() != 2,
+                      JSON::Exception("invalid file was published."));
+        
+        // Changes in a burst are parsed once they stop.
+        JSON::Watcher::Stats before = watcher.stats();
+        
+        for (int v = 3; v <= 12; ++v)
+            write("{\"version\": " + std::to_string(v) + "}");
+        
+        JSON_THROW_IF(!await([&] { return watcher.load()["version"].toInt64() == 12; }) || published != 12 ||
+                      watcher.stats().events - before.events < 10 || watcher.stats().reloads - before.reloads > 2 ||
+                      !watcher.error().empty(),
+                      JSON::Exception("burst of changes was not debounced."));
+    }
+    
+    std::remove(file);
+    JSON_THROW_IF(!isRejectedBy([file] { JSON::Watcher watcher(file); }), JSON::Exception("missing file was watched."));
+}
+
+//! @brief Writes a document compactly, pretty-printed, into a stream and into a file descriptor,
+//! and checks the outputs parse back and rewriting into a cleared buffer allocates nothing.
+static void checkWriter()
+{
+    JSON doc = JSON::loadContent("{\"s\": \"quote\\\" slash\\\\ tab\\t ctl\\u0001\", \"n\": [1, -2, 2.5, true, null],"
+                                 " \"o\": {\"e\": {}, \"a\": []}}");
+    
+    JSON::Writer compact(JSON::Writer::L_COMPACT);
+    compact.write(doc);
+    
+    std::string expected = "{\"s\":\"quote\\\" slash\\\\ tab\\t ctl\\u0001\",\"n\":[1,-2,2.5,true,null],"
+                           "\"o\":{\"e\":{},\"a\":[]}}";
+    JSON_THROW_IF(compact.content() != expected, JSON::Exception("compact output is '%s'.",
+                                                                 std::string(compact.content()).data()));
+    JSON_THROW_IF(JSON::loadContent(doc.str()).str() != doc.str(), JSON::Exception("pretty output does not parse back."));
+    
+    JSON::Writer pretty(JSON::Writer::L_PRETTY, "  ");
+    pretty.write(doc["o"]);
+    JSON_THROW_IF(pretty.content() != "\"o\": {\n  \"e\": {},\n  \"a\": []\n}", JSON::Exception("pretty output is '%s'.",
+                                                                 std::string(pretty.content()).data()));
+    
+    // Writing again into the cleared buffer allocates nothing.
+    compact.clear();
+    std::size_t before = gAllocations;
+    compact.write(doc);
+    JSON_THROW_IF(gAllocations != before, JSON::Exception("rewriting made %zu allocations.", gAllocations - before));
+    
+    std::ostringstream stream;
+    stream << doc;
+    JSON_THROW_IF(stream.str() != doc.str(), JSON::Exception("stream output differs."));
+    
+#if defined(__linux__)
+    int fds[2];
+    JSON_THROW_IF(pipe(fds) != 0, JSON::Exception("cannot create pipe."));
+    
+    {
+        JSON::Writer piped(fds[1], JSON::Writer::L_COMPACT);
+        piped.write(doc);
+    }
+    
+    close(fds[1]);
+    char buffer[256];
+    ssize_t size = read(fds[0], buffer, sizeof(buffer));
+    close(fds[0]);
+    
+    JSON_THROW_IF(std::string(buffer, size > 0 ? size : 0) != expected, JSON::Exception("file descriptor output differs."));
+#endif
+    
+    checkRoundTrip();
+}
+
 int main(int argc, char** argv)
 {
     try
@@ -73,6 +1308,34 @@ int main(int argc, char** argv)
         T1 hello;
         mainObj["fromMap"]["Hello"] >> hello;
         
+        checkArena("AMakeFile.json");
+        checkLargeObject(4);
+        checkLargeObject(5000);
+        checkInSitu();
+        checkLoad("AMakeFile.json");
+        checkScanning();
+        checkNumbers();
+        checkEvents();
+        checkPushParser();
+        checkLazy("AMakeFile.json");
+        checkWriter();
+        checkSerialize();
+        checkParseInto();
+        checkLines();
+        checkArrays();
+        checkBinary();
+        checkImage();
+        checkPath();
+        checkIntern();
+        checkCopyOnWrite();
+        checkSnapshot();
+        checkWatcher();
+        
+        // Nodes are moved into place: twice the depth costs twice the allocations.
+        std::size_t shallow = nestedAllocations(64), deep = nestedAllocations(128);
+        JSON_THROW_IF(deep > 2 * shallow + 8, JSON::Exception("parsing copies subtrees: %zu allocations for depth 64, "
+                                                              "%zu for depth 128.", shallow, deep));
+        
         return 0;
     }
     
@@ -1,300 +1,1217 @@
 // JSONParser.cpp
-// The simple C++ JSON Parser. 
+// The simple C++ JSON Parser.
 // Copyright 2019 @Atlanti's Corp
 
 #include "JSONPP.h"
+#include "JSONScanner.h"
+#include "JSONReader.h"
 
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <istream>
 
-static std::size_t findNextCharacter(const std::string& content, std::size_t pos,
-                                     std::size_t& currLine, std::size_t& currCol);
-static std::string parseString(const std::string& content, std::size_t& pos, std::size_t& currLine,
-                               std::size_t& currCol);
-static JSON::Array readArray(const std::string& content, std::size_t& pos, std::size_t& currLine,
-                             std::size_t& currCol);
-static JSON::Number readNumber(const std::string& content, std::size_t& pos, std::size_t& currLine,
-                               std::size_t& currCol);
-static JSON::Value readValueContent(const std::string& name, const std::string& content,
-                                    std::size_t& pos, std::size_t& currLine, std::size_t& currCol);
-static JSON::Value readValue(const std::string& content, std::size_t& pos, std::size_t& currLine,                                      std::size_t& currCol);
-static JSON readObject(const std::string& content, std::size_t& pos,
-                       std::size_t& currLine, std::size_t& currCol);
-
-static std::size_t findFirstCharacter(const std::string& content, std::size_t pos,
-                                      std::size_t& currLine, std::size_t& currCol)
-{
-    while(std::isspace(content[pos]))
-    {
-        if (content[pos] == '\n')
-        {
-            currLine = currLine + 1;
-            currCol = 0;
-        }
-        
+#if defined(__unix__) || defined(__APPLE__)
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   define JSON_HAS_MMAP 1
+#endif
+
+JSON::Reader::Reader(std::string_view content, Arena* arena, Storage storage)
+: mContent(content)
+, mPos(0)
+, mLine(0)
+, mCol(0)
+, mArena(arena)
+, mStorage(arena ? S_COPY : storage)
+{
+
+}
+
+char JSON::Reader::current() const
+{
+    return mPos < mContent.size() ? mContent[mPos] : '\0';
+}
+
+void JSON::Reader::findFirstCharacter()
+{
+    // Most tokens are not preceded by whitespaces, or by a single space.
+    if (mPos >= mContent.size() || static_cast < unsigned char >(mContent[mPos]) > ' ')
+        return;
+
+    const char* begin = mContent.data() + mPos;
+    Scanner::Lines lines;
+    const char* stop = Scanner::skipWhitespace(begin, mContent.data() + mContent.size(), lines);
+
+    if (lines.count)
+    {
+        mLine = mLine + lines.count;
+        mCol = stop - (lines.last + 1);
+    }
+
+    else
+        mCol = mCol + (stop - begin);
+
+    mPos = stop - mContent.data();
+
+    JSON_THROW_IF(stop != begin && mPos >= mContent.size(), JSON::Exception("Parser(%i:%i): no character found.",
+                                                                            mLine, mCol));
+}
+
+void JSON::Reader::findNextCharacter()
+{
+    mPos = mPos + 1;
+    mCol = mCol + 1;
+	findFirstCharacter();
+}
+
+std::string_view JSON::Reader::parseString(bool& escaped)
+{
+	JSON_THROW_IF(current() != '"', JSON::Exception("Parser(%i:%i): expected '\"'.",
+	mLine, mCol));
+
+    std::size_t begin = mPos + 1, end = begin;
+
+    end = Scanner::findQuoteOrEscape(mContent.data() + begin, mContent.data() + mContent.size()) - mContent.data();
+
+    mCol = mCol + (end - mPos);
+    mPos = end;
+
+    JSON_THROW_IF(mPos >= mContent.size(), JSON::Exception("Parser(%i:%i): unexpected EOF.",
+    mLine, mCol));
+
+    escaped = mContent[mPos] == '\\';
+
+    if (!escaped)
+        return mContent.substr(begin, end - begin);
+
+    mScratch.assign(mContent.data() + begin, end - begin);
+
+    while (current() != '"')
+    {
+        JSON_THROW_IF(mPos >= mContent.size(), JSON::Exception("Parser(%i:%i): unexpected EOF.",
+        mLine, mCol));
+
+        if (mContent[mPos] == '\\')
+            parseEscape();
+
         else
-            currCol = currCol + 1;
-        
-        pos = pos + 1;
-        
-        JSON_THROW_IF(pos >= content.size(), JSON::Exception("Parser(%i:%i): no character found.",
-                                                             currLine, currCol));
+            mScratch.push_back(mContent[mPos]);
+
+        mPos = mPos + 1;
+        mCol = mCol + 1;
     }
-    
-    return pos;
+
+    return mScratch;
 }
 
-static std::size_t findNextCharacter(const std::string& content, std::size_t pos, 
-									 std::size_t& currLine, std::size_t& currCol)
+//! @brief Returns the value of the hexadecimal digit, or -1.
+static int hexDigit(char c)
 {
-    pos = pos + 1;
-    currCol = currCol + 1;
-	return findFirstCharacter(content, pos, currLine, currCol);
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
 }
 
-static std::string parseString(const std::string& content, std::size_t& pos, std::size_t& currLine,
-							   std::size_t& currCol)
+//! @brief Reads the four hexadecimal digits at pos, or returns -1.
+static long readHex4(std::string_view content, std::size_t pos)
 {
-	JSON_THROW_IF(content[pos] != '"', JSON::Exception("Parser(%i:%i): expected '\"'.",
-	currLine, currCol));
-	
-	std::string result;
-	
-	do 
-	{
-        pos = pos + 1;
-        currCol = currCol + 1;
-        
-        JSON_THROW_IF(pos >= content.size(), JSON::Exception("Parser(%i:%i): unexpected EOF.",
-        currLine, currCol));
-        
-        if (content[pos] == '"')
-            break;
-        
-		result.push_back(content[pos]);
+    if (pos + 4 > content.size())
+        return -1;
 
-	} while(content[pos] != '"');
-	
-	return result;
+    long result = 0;
+
+    for (std::size_t i = pos; i < pos + 4; ++i)
+    {
+        int digit = hexDigit(content[i]);
+
+        if (digit < 0)
+            return -1;
+
+        result = result * 16 + digit;
+    }
+
+    return result;
 }
 
-static JSON::Array readArray(const std::string& content, std::size_t& pos, std::size_t& currLine,
-						     std::size_t& currCol)
+void JSON::Reader::parseEscape()
 {
-	JSON_THROW_IF(content[pos] != '[', JSON::Exception("Parser(%i:%i): expected '['.",
-	currLine, currCol));
-	
-	JSON::Array array;
-	
-	while (content[pos] != ']')
+    mPos = mPos + 1;
+    mCol = mCol + 1;
+
+    switch (current())
+    {
+        case '"': mScratch.push_back('"'); return;
+        case '\\': mScratch.push_back('\\'); return;
+        case '/': mScratch.push_back('/'); return;
+        case 'b': mScratch.push_back('\b'); return;
+        case 'f': mScratch.push_back('\f'); return;
+        case 'n': mScratch.push_back('\n'); return;
+        case 'r': mScratch.push_back('\r'); return;
+        case 't': mScratch.push_back('\t'); return;
+        case 'u': break;
+
+        default:
+        JSON_THROW(JSON::Exception("Parser(%i:%i): invalid escape sequence.", mLine, mCol));
+    }
+
+    long code = readHex4(mContent, mPos + 1);
+    JSON_THROW_IF(code < 0, JSON::Exception("Parser(%i:%i): invalid unicode escape.", mLine, mCol));
+
+    mPos = mPos + 4;
+    mCol = mCol + 4;
+
+    // A high surrogate must be followed by an escaped low surrogate.
+    if (code >= 0xD800 && code <= 0xDBFF)
+    {
+        long low = mPos + 2 < mContent.size() && mContent[mPos + 1] == '\\' && mContent[mPos + 2] == 'u' ?
+                   readHex4(mContent, mPos + 3) : -1;
+
+        JSON_THROW_IF(low < 0xDC00 || low > 0xDFFF, JSON::Exception("Parser(%i:%i): unpaired surrogate.",
+        mLine, mCol));
+
+        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        mPos = mPos + 6;
+        mCol = mCol + 6;
+    }
+
+    if (code < 0x80)
+        mScratch.push_back(static_cast < char >(code));
+
+    else if (code < 0x800)
+    {
+        mScratch.push_back(static_cast < char >(0xC0 | (code >> 6)));
+        mScratch.push_back(static_cast < char >(0x80 | (code & 0x3F)));
+    }
+
+    else if (code < 0x10000)
+    {
+        mScratch.push_back(static_cast < char >(0xE0 | (code >> 12)));
+        mScratch.push_back(static_cast < char >(0x80 | ((code >> 6) & 0x3F)));
+        mScratch.push_back(static_cast < char >(0x80 | (code & 0x3F)));
+    }
+
+    else
+    {
+        mScratch.push_back(static_cast < char >(0xF0 | (code >> 18)));
+        mScratch.push_back(static_cast < char >(0x80 | ((code >> 12) & 0x3F)));
+        mScratch.push_back(static_cast < char >(0x80 | ((code >> 6) & 0x3F)));
+        mScratch.push_back(static_cast < char >(0x80 | (code & 0x3F)));
+    }
+}
+
+JSON::Array JSON::Reader::readArray()
+{
+	JSON_THROW_IF(current() != '[', JSON::Exception("Parser(%i:%i): expected '['.",
+	mLine, mCol));
+
+	JSON::Array array(mArena ? mArena->resource() : std::pmr::get_default_resource());
+	readElements(array, std::string_view::npos);
+	return array;
+}
+
+void JSON::Reader::readElements(JSON::Array& array, std::size_t stop)
+{
+	do
 	{
-		pos = findNextCharacter(content, pos, currLine, currCol);
-		
-		if (pos == ']')
+		// A bracket closes the array right after it opens, never after a comma.
+		bool first = current() == '[';
+		findNextCharacter();
+
+		if (first && current() == ']')
 			break;
-		
-		JSON::Value value = readValueContent(std::to_string(array.size()), content, pos, currLine, currCol);
-		array.push_back(value);
-		
-		pos = findNextCharacter(content, pos, currLine, currCol);
-		
-		JSON_THROW_IF(content[pos] != ',' && content[pos] != ']', 
+
+		array.push_back(readValueContent(std::string_view(), true));
+
+		findNextCharacter();
+
+		JSON_THROW_IF(current() != ',' && current() != ']',
 		JSON::Exception("Parser(%i:%i): unexpected character %c.",
-		currLine, currCol, content[pos]));
+		mLine, mCol, current()));
 	}
-	
-	return array;
+	while (current() != ']' && mPos < stop);
 }
 
-static JSON::Number readNumber(const std::string& content, std::size_t& pos, std::size_t& currLine,
-						       std::size_t& currCol)
-{
-	bool isNeg = content[pos] == '-';
-	bool hasPoint = false;
-	
-	JSON_THROW_IF(!isNeg && !std::isdigit(content[pos]),
-	JSON::Exception("Parser(%i:%i): unexepected character %c.",
-	currLine, currCol, content[pos]));
-	
-	std::string alnum;
-	if (isNeg) alnum.push_back('-');
-    alnum.push_back(content[pos]);
-	
-	while (content[pos] != ',')
-	{
-		pos = pos + 1;
-        currCol = currCol + 1;
-		
-		if (std::isdigit(content[pos]))
-			alnum.push_back(content[pos]);
-		
-		else if (content[pos] == '.')
-		{
-			JSON_THROW_IF(hasPoint, JSON::Exception("Parser(%i:%i): unexpected floating point.",
-			currLine, currCol));
-			
-			alnum.push_back(content[pos]);
-			hasPoint = true;
-		}
-        
-        else if(content[pos] != ',')
-        {
-            JSON_THROW(JSON::Exception("Parser(%i:%i): unexepected character %c.",
-            currLine, currCol, content[pos]));
-        }
-		
-		JSON_THROW_IF(pos >= content.size(), JSON::Exception("Parser(%i:%i): unexpected EOF.",
-		currLine, currCol));
-	}
-	
-    pos = pos - 1;
-    currCol = currCol - 1;
-    return strtof(alnum.data(), NULL);
+void JSON::Reader::seek(std::size_t offset)
+{
+    const char* begin = mContent.data() + mPos, *end = mContent.data() + offset;
+    const char* last = nullptr;
+
+    for (const char* it = begin; (it = static_cast < const char* >(std::memchr(it, '\n', end - it))); it = it + 1)
+    {
+        mLine = mLine + 1;
+        last = it;
+    }
+
+    mCol = last ? end - (last + 1) : mCol + (end - begin);
+    mPos = offset;
 }
 
-static bool readBoolean(const std::string& content, std::size_t& pos, std::size_t& currLine,
-                        std::size_t& currCol)
+void JSON::Reader::readNumber(JSON::Value& value)
 {
-    JSON_THROW_IF(content[pos] != 't' && content[pos] != 'f',
+    const char* begin = mContent.data() + mPos;
+    const char* end = mContent.data() + mContent.size();
+    const char* it = begin;
+    bool isInteger = true;
+
+    // Validates the JSON grammar first: from_chars accepts forms JSON does not.
+    if (it < end && *it == '-')
+        it = it + 1;
+
+    JSON_THROW_IF(it == end || !std::isdigit(static_cast < unsigned char >(*it)),
+    JSON::Exception("Parser(%i:%i): unexepected character %c.", mLine, mCol, current()));
+
+    if (*it == '0')
+        it = it + 1;
+
+    else while (it < end && std::isdigit(static_cast < unsigned char >(*it)))
+        it = it + 1;
+
+    if (it < end && *it == '.')
+    {
+        it = it + 1;
+        isInteger = false;
+
+        JSON_THROW_IF(it == end || !std::isdigit(static_cast < unsigned char >(*it)),
+        JSON::Exception("Parser(%i:%i): expected a digit after the floating point.",
+        mLine, mCol + (it - begin)));
+
+        while (it < end && std::isdigit(static_cast < unsigned char >(*it)))
+            it = it + 1;
+    }
+
+    if (it < end && (*it == 'e' || *it == 'E'))
+    {
+        it = it + 1;
+        isInteger = false;
+
+        if (it < end && (*it == '+' || *it == '-'))
+            it = it + 1;
+
+        JSON_THROW_IF(it == end || !std::isdigit(static_cast < unsigned char >(*it)),
+        JSON::Exception("Parser(%i:%i): expected a digit in the exponent.",
+        mLine, mCol + (it - begin)));
+
+        while (it < end && std::isdigit(static_cast < unsigned char >(*it)))
+            it = it + 1;
+    }
+
+    // Integers are kept exact, unless they overflow 64 bits and fall back to a double.
+    bool parsed = false;
+
+    if (isInteger && *begin == '-')
+    {
+        std::int64_t integer;
+        parsed = std::from_chars(begin, it, integer).ec == std::errc();
+
+        if (parsed)
+            value = integer;
+    }
+
+    else if (isInteger)
+    {
+        std::uint64_t integer;
+        parsed = std::from_chars(begin, it, integer).ec == std::errc();
+
+        if (parsed)
+            value = integer;
+    }
+
+    if (!parsed)
+    {
+        double number;
+        std::from_chars_result result = std::from_chars(begin, it, number);
+
+        JSON_THROW_IF(result.ec == std::errc::invalid_argument,
+        JSON::Exception("Parser(%i:%i): invalid number.", mLine, mCol));
+
+        // Out of range: from_chars leaves the number unchanged, strtod gives the infinity or
+        // the zero it rounds to.
+        if (result.ec == std::errc::result_out_of_range)
+            number = std::strtod(std::string(begin, it).data(), nullptr);
+
+        value = number;
+    }
+
+    // Leaves the position on the last character of the number.
+    mPos = mPos + (it - begin) - 1;
+    mCol = mCol + (it - begin) - 1;
+}
+
+bool JSON::Reader::readBoolean()
+{
+    JSON_THROW_IF(current() != 't' && current() != 'f',
     JSON::Exception("Parser(%i:%i): expected character 't' or 'f'.",
-    currLine, currCol));
-    
-    JSON_THROW_IF(pos + 3 >= content.size(),
+    mLine, mCol));
+
+    JSON_THROW_IF(mPos + 3 >= mContent.size(),
     JSON::Exception("Parser(%i:%i): expected at least 4 characters.",
-    currLine, currCol));
-    
-    if (content[pos]     == 't' &&
-        content[pos + 1] == 'r' &&
-        content[pos + 2] == 'u' &&
-        content[pos + 3] == 'e')
-    {
-        pos = pos + 3;
-        currCol = currCol + 3;
+    mLine, mCol));
+
+    if (mContent.compare(mPos, 4, "true") == 0)
+    {
+        mPos = mPos + 3;
+        mCol = mCol + 3;
         return true;
     }
-    
-    JSON_THROW_IF(pos + 4 >= content.size(),
+
+    JSON_THROW_IF(mPos + 4 >= mContent.size(),
     JSON::Exception("Parser(%i:%i): expected at least 5 characters.",
-    currLine, currCol));
-    
-    if (content[pos]     == 'f' &&
-        content[pos + 1] == 'a' &&
-        content[pos + 2] == 'l' &&
-        content[pos + 3] == 's' &&
-        content[pos + 4] == 'e')
-    {
-        pos = pos + 4;
-        currCol = currCol + 4;
+    mLine, mCol));
+
+    if (mContent.compare(mPos, 5, "false") == 0)
+    {
+        mPos = mPos + 4;
+        mCol = mCol + 4;
         return false;
     }
-    
+
     JSON_THROW(JSON::Exception("Parser(%i:%i): unexpected character %c.",
-    currLine, currCol, content[pos]));
+    mLine, mCol, current()));
     return false;
 }
 
-static JSON::Value readValueContent(const std::string& name, const std::string& content, 
-									std::size_t& pos, std::size_t& currLine, std::size_t& currCol)
+void JSON::Reader::readNull()
 {
-	if (content[pos] == '"')
-	{
-		std::string str = parseString(content, pos, currLine, currCol);
-		return JSON::Value(name, str);
-	}
-	
-	else if (content[pos] == '{')
-	{
-		JSON obj = readObject(content, pos, currLine, currCol);
-		return JSON::Value(name, obj);
-	}
-	
-	else if (content[pos] == '[')
-	{
-		JSON::Array array = readArray(content, pos, currLine, currCol);
-		return JSON::Value(name, array);
-	}
-	
-	else if (std::isdigit(content[pos]) || content[pos] == '-')
-	{
-		JSON::Number num = readNumber(content, pos, currLine, currCol);
-		return JSON::Value(name, num);
-	}
-    
-    else if (content[pos] == 't' || content[pos] == 'f')
+    JSON_THROW_IF(mContent.compare(mPos, 4, "null") != 0,
+    JSON::Exception("Parser(%i:%i): unexpected character %c.",
+    mLine, mCol, current()));
+
+    mPos = mPos + 3;
+    mCol = mCol + 3;
+}
+
+std::string_view JSON::Reader::readKey(bool& escaped)
+{
+	JSON_THROW_IF(current() != '"', JSON::Exception("Parser(%i:%i): key/value should begin with a string.",
+	mLine, mCol));
+
+	std::string_view key = parseString(escaped);
+	JSON_THROW_IF(key.empty(), JSON::Exception("Parser(%i:%i): key cannot be empty.",
+	mLine, mCol));
+
+	findNextCharacter();
+	JSON_THROW_IF(current() != ':', JSON::Exception("Parser(%i:%i): ':' was expected.",
+	mLine, mCol));
+
+	findNextCharacter();
+	return key;
+}
+
+//! @param name The name of the value. It is copied unless the document views the content
+//! and escaped is false, so it may point to the scratch buffer.
+JSON::Value JSON::Reader::readValueContent(std::string_view name, bool escaped)
+{
+    JSON::Value value;
+
+    if (mArena)
+        value.assignName(name, *mArena);
+
+    else if (mStorage == S_IN_SITU && !escaped)
+        value.borrowName(name);
+
+    else
+        value.assignName(name);
+
+    if (current() == '"')
+    {
+        std::string_view str = parseString(escaped);
+
+        if (mArena)
+            value.assign(std::string(str), *mArena);
+
+        else if (mStorage == S_IN_SITU && !escaped)
+            value.borrowString(str);
+
+        else
+            value = std::string(str);
+    }
+
+    else if (current() == '{')
+    {
+        JSON obj = readObject();
+
+        if (mArena)
+            value.assign(std::move(obj), *mArena);
+
+        else
+            value = std::move(obj);
+
+        // Its copies must not view the content either.
+        if (mStorage == S_IN_SITU)
+            value.mFlags |= Value::F_PAYLOAD_UNSHARED;
+    }
+
+    else if (current() == '[')
+    {
+        JSON::Array array = readArray();
+
+        if (mArena)
+            value.assign(std::move(array), *mArena);
+
+        else
+            value = std::move(array);
+
+        if (mStorage == S_IN_SITU)
+            value.mFlags |= Value::F_PAYLOAD_UNSHARED;
+    }
+
+    else if (std::isdigit(static_cast < unsigned char >(current())) || current() == '-')
+    {
+        readNumber(value);
+    }
+
+    else if (current() == 't' || current() == 'f')
+    {
+        value = readBoolean();
+    }
+
+    else if (current() == 'n')
     {
-        bool b = readBoolean(content, pos, currLine, currCol);
-        return JSON::Value(name, b);
+        readNull();
     }
-	
-	JSON_THROW(JSON::Exception("Parser(%i:%i): unexpected character %c.",
-	currLine, currCol, content[pos]));
-	return JSON::Value();
+
+    else
+    {
+        JSON_THROW(JSON::Exception("Parser(%i:%i): unexpected character %c.",
+        mLine, mCol, current()));
+    }
+
+    return value;
 }
 
-static JSON::Value readValue(const std::string& content, std::size_t& pos, std::size_t& currLine, 							 std::size_t& currCol)
+JSON::Value JSON::Reader::readValue()
 {
-	JSON_THROW_IF(content[pos] != '"', JSON::Exception("Parser(%i:%i): key/value should begin with a string.",
-	currLine, currCol));
-	
-	std::string key = parseString(content, pos, currLine, currCol);
-	JSON_THROW_IF(key.empty(), JSON::Exception("Parser(%i:%i): key cannot be empty.",
-	currLine, currCol));
-	
-	pos = findNextCharacter(content, pos, currLine, currCol);
-	JSON_THROW_IF(content[pos] != ':', JSON::Exception("Parser(%i:%i): ':' was expected.",
-	currLine, currCol));
-	
-	pos = findNextCharacter(content, pos, currLine, currCol);
-	return readValueContent(key, content, pos, currLine, currCol);
-}
-
-static JSON readObject(const std::string& content, std::size_t& pos,
-                       std::size_t& currLine, std::size_t& currCol)
-{
-	JSON_THROW_IF(content[pos] != '{', JSON::Exception("Parser(%i:%i): object should begin with a '{'.",
-	currLine, currCol));
-	
-	JSON result;
-	
-	while(content[pos] != '}')
+	bool escaped;
+	std::string_view key = readKey(escaped);
+	return readValueContent(key, escaped);
+}
+
+JSON JSON::Reader::readObject()
+{
+	JSON_THROW_IF(current() != '{', JSON::Exception("Parser(%i:%i): object should begin with a '{'.",
+	mLine, mCol));
+
+	JSON result = mArena ? JSON(*mArena) : JSON();
+
+	while(current() != '}')
 	{
-		pos = findNextCharacter(content, pos, currLine, currCol);
-		
-		if (pos == '}')
+		// A bracket closes the object right after it opens, never after a comma.
+		bool first = current() == '{';
+		findNextCharacter();
+
+		if (first && current() == '}')
 		break;
-		
-		JSON::Value value = readValue(content, pos, currLine, currCol);
-		result.addValue(value);
-		
-		pos = findNextCharacter(content, pos, currLine, currCol);
-		
-		JSON_THROW_IF(content[pos] != ',' && content[pos] != '}', 
+
+		result.addValue(readValue());
+
+		findNextCharacter();
+
+		JSON_THROW_IF(current() != ',' && current() != '}',
 		JSON::Exception("Parser(%i:%i): unexpected character %c.",
-		currLine, currCol, content[pos]));
+		mLine, mCol, current()));
 	};
-    
+
+    // Its copies must not view the content: they copy the members.
+    if (mStorage == S_IN_SITU && result.mMembers)
+        result.mMembers->unshared = true;
+
     return result;
 }
 
+JSON JSON::Reader::readDocument()
+{
+    findFirstCharacter();
+    JSON_THROW_IF(current() != '{', Exception("Parser(%i:%i): first character should be a '{'.",
+    mLine, mCol));
+
+    return readObject();
+}
+
+JSON JSON::Reader::readRecord(std::size_t line)
+{
+    mLine = line;
+
+    JSON record = readDocument();
+    checkEnd();
+    return record;
+}
+
+void JSON::Reader::checkEnd()
+{
+    Scanner::Lines lines;
+    const char* begin = mContent.data() + mPos + 1, *end = mContent.data() + mContent.size();
+    const char* stop = Scanner::skipWhitespace(begin, end, lines);
+
+    if (stop != end)
+    {
+        mPos = stop - mContent.data();
+        mLine = mLine + lines.count;
+        mCol = lines.count ? stop - (lines.last + 1) : mCol + 1 + (stop - begin);
+        JSON_THROW(Exception("Parser(%i:%i): unexpected character %c after the document.",
+        mLine, mCol, current()));
+    }
+}
+
+JSON::Array JSON::Reader::readArrayDocument(unsigned threads)
+{
+    findFirstCharacter();
+    JSON_THROW_IF(current() != '[', Exception("Parser(%i:%i): first character should be a '['.",
+    mLine, mCol));
+
+    JSON::Array array(mArena ? mArena->resource() : std::pmr::get_default_resource());
+
+    // Arenas are not shared between threads, and small arrays are not worth splitting.
+    if (threads != 1 && !mArena && mContent.size() - mPos >= 2 * JSON_ARRAY_PIECE)
+        readElementsInParallel(array, threads);
+
+    else
+        readElements(array, std::string_view::npos);
+
+    checkEnd();
+    return array;
+}
+
+void JSON::Reader::parseValue(Handler& handler)
+{
+    bool escaped;
+
+    switch (current())
+    {
+        case '"': handler.string(parseString(escaped)); break;
+        case '{': parseObject(handler); break;
+        case '[': parseArray(handler); break;
+        case 't': case 'f': handler.boolean(readBoolean()); break;
+        case 'n': readNull(); handler.null(); break;
+
+        default:
+        {
+            JSON_THROW_IF(!std::isdigit(static_cast < unsigned char >(current())) && current() != '-',
+            JSON::Exception("Parser(%i:%i): unexpected character %c.",
+            mLine, mCol, current()));
+
+            // Numbers go through a nameless Value, which never allocates.
+            JSON::Value number;
+            readNumber(number);
+            sendNumber(number, handler);
+        }
+    }
+}
+
+void JSON::Reader::sendNumber(const Value& number, Handler& handler)
+{
+    if (number.mFlags & Value::F_INTEGER)
+        handler.integer(number.mInteger);
+
+    else if (number.mFlags & Value::F_UNSIGNED)
+        handler.unsignedInteger(number.mUnsigned);
+
+    else
+        handler.number(number.mNumber);
+}
+
+void JSON::Reader::parseArray(Handler& handler)
+{
+    handler.startArray();
+
+	while (current() != ']')
+	{
+		bool first = current() == '[';
+		findNextCharacter();
+
+		if (first && current() == ']')
+			break;
+
+		parseValue(handler);
+
+		findNextCharacter();
+
+		JSON_THROW_IF(current() != ',' && current() != ']',
+		JSON::Exception("Parser(%i:%i): unexpected character %c.",
+		mLine, mCol, current()));
+	}
+
+    handler.endArray();
+}
+
+void JSON::Reader::parseObject(Handler& handler)
+{
+    handler.startObject();
+
+	while(current() != '}')
+	{
+		bool first = current() == '{';
+		findNextCharacter();
+
+		if (first && current() == '}')
+		break;
+
+		bool escaped;
+		handler.key(readKey(escaped));
+		parseValue(handler);
+
+		findNextCharacter();
+
+		JSON_THROW_IF(current() != ',' && current() != '}',
+		JSON::Exception("Parser(%i:%i): unexpected character %c.",
+		mLine, mCol, current()));
+	}
+
+    handler.endObject();
+}
+
+void JSON::Reader::parseDocument(Handler& handler)
+{
+    findFirstCharacter();
+    JSON_THROW_IF(mPos >= mContent.size(), Exception("Parser(%i:%i): no character found.",
+    mLine, mCol));
+
+    parseValue(handler);
+    checkEnd();
+}
+
+JSON::PushParser::PushParser(Handler& handler)
+: mHandler(handler)
+, mState(S_VALUE)
+, mIsKey(false)
+, mEscape(false)
+, mHasEscape(false)
+, mAfterComma(false)
+, mLiteral(nullptr)
+, mLiteralPos(0)
+, mLine(0)
+, mCol(0)
+, mTokenLine(0)
+, mTokenCol(0)
+{
+
+}
+
+const char* JSON::PushParser::skipWhitespace(const char* it, const char* end)
+{
+    Scanner::Lines lines;
+    const char* stop = Scanner::skipWhitespace(it, end, lines);
+
+    if (lines.count)
+    {
+        mLine = mLine + lines.count;
+        mCol = stop - (lines.last + 1);
+    }
+
+    else
+        mCol = mCol + (stop - it);
+
+    return stop;
+}
+
+void JSON::PushParser::startValue(const char* it)
+{
+    mTokenLine = mLine;
+    mTokenCol = mCol;
+
+    switch (*it)
+    {
+        case '"':
+            mState = S_STRING;
+            mIsKey = false;
+            mHasEscape = false;
+            break;
+
+        case '{':
+            mStack.push_back('{');
+            mHandler.startObject();
+            mState = S_KEY;
+            break;
+
+        case '[':
+            mStack.push_back('[');
+            mHandler.startArray();
+            mState = S_VALUE;
+            break;
+
+        case 't': mLiteral = "true"; mLiteralPos = 1; mState = S_LITERAL; break;
+        case 'f': mLiteral = "false"; mLiteralPos = 1; mState = S_LITERAL; break;
+        case 'n': mLiteral = "null"; mLiteralPos = 1; mState = S_LITERAL; break;
+
+        default:
+            JSON_THROW_IF(!std::isdigit(static_cast < unsigned char >(*it)) && *it != '-',
+            JSON::Exception("Parser(%i:%i): unexpected character %c.",
+            mLine, mCol, *it));
+
+            mState = S_NUMBER;
+    }
+}
+
+void JSON::PushParser::close(const char* it)
+{
+    // Only the bracket closing the innermost container may follow a value there.
+    JSON_THROW_IF(mStack.empty() || *it != (mStack.back() == '{' ? '}' : ']'),
+    JSON::Exception("Parser(%i:%i): unexpected character %c.",
+    mLine, mCol, *it));
+
+    mStack.pop_back();
+
+    if (*it == '}')
+        mHandler.endObject();
+
+    else
+        mHandler.endArray();
+
+    endValue();
+}
+
+void JSON::PushParser::endValue()
+{
+    mState = S_AFTER;
+}
+
+void JSON::PushParser::sendString(std::string_view token)
+{
+    std::string_view string = token.substr(1, token.size() - 2);
+
+    // Escapes are decoded by a Reader placed where the token began.
+    Reader reader(token, nullptr, S_COPY);
+
+    if (mHasEscape)
+    {
+        reader.mLine = mTokenLine;
+        reader.mCol = mTokenCol;
+
+        bool escaped;
+        string = reader.parseString(escaped);
+    }
+
+    if (mIsKey)
+    {
+        JSON_THROW_IF(string.empty(), JSON::Exception("Parser(%i:%i): key cannot be empty.",
+        mTokenLine, mTokenCol));
+
+        mHandler.key(string);
+        mState = S_COLON;
+    }
+
+    else
+    {
+        mHandler.string(string);
+        endValue();
+    }
+}
+
+void JSON::PushParser::sendNumber(std::string_view token)
+{
+    Reader reader(token, nullptr, S_COPY);
+    reader.mLine = mTokenLine;
+    reader.mCol = mTokenCol;
+
+    JSON::Value number;
+    reader.readNumber(number);
+
+    // The token holds every character a number may hold, which readNumber may not accept.
+    JSON_THROW_IF(reader.mPos + 1 != token.size(), JSON::Exception("Parser(%i:%i): unexpected character %c.",
+    reader.mLine, reader.mCol + 1, token[reader.mPos + 1]));
+
+    Reader::sendNumber(number, mHandler);
+    endValue();
+}
+
+//! @brief Returns true for the characters a number is made of.
+static bool isNumberCharacter(char c)
+{
+    return std::isdigit(static_cast < unsigned char >(c)) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+void JSON::PushParser::feed(const char* data, std::size_t size)
+{
+    const char* it = data, *end = data + size;
+
+    // The current token begins in this chunk at token, or in mBuffer if it began before.
+    const char* token = data;
+
+    while (it < end)
+    {
+        switch (mState)
+        {
+            case S_VALUE:
+            case S_KEY:
+            case S_COLON:
+            case S_AFTER:
+            {
+                it = skipWhitespace(it, end);
+
+                if (it == end)
+                    break;
+
+                token = it;
+
+                // A bracket may close the container only if nothing was read since it opened:
+                // after a ',', it is read as a value or a key and rejected like the Reader does.
+                if (mState == S_VALUE)
+                {
+                    if (*it == ']' && !mAfterComma)
+                        close(it);
+
+                    else
+                        startValue(it);
+
+                    mAfterComma = false;
+                }
+
+                else if (mState == S_KEY)
+                {
+                    if (*it == '}' && !mAfterComma)
+                        close(it);
+
+                    else
+                    {
+                        JSON_THROW_IF(*it != '"', JSON::Exception("Parser(%i:%i): key/value should begin with a string.",
+                        mLine, mCol));
+
+                        mTokenLine = mLine;
+                        mTokenCol = mCol;
+                        mState = S_STRING;
+                        mIsKey = true;
+                        mHasEscape = false;
+                    }
+
+                    mAfterComma = false;
+                }
+
+                else if (mState == S_COLON)
+                {
+                    JSON_THROW_IF(*it != ':', JSON::Exception("Parser(%i:%i): ':' was expected.",
+                    mLine, mCol));
+
+                    mState = S_VALUE;
+                }
+
+                // After a value: a top-level value starts the next one.
+                else if (mStack.empty())
+                    startValue(it);
+
+                else if (*it == ',')
+                {
+                    mState = mStack.back() == '{' ? S_KEY : S_VALUE;
+                    mAfterComma = true;
+                }
+
+                else
+                    close(it);
+
+                // Numbers are only complete on the character after them.
+                if (mState != S_NUMBER)
+                {
+                    it = it + 1;
+                    mCol = mCol + 1;
+                }
+
+                break;
+            }
+
+            case S_STRING:
+            {
+                // The opening quote was consumed with the state change.
+                if (mEscape)
+                {
+                    mEscape = false;
+                    it = it + 1;
+                    mCol = mCol + 1;
+                    break;
+                }
+
+                const char* stop = Scanner::findQuoteOrEscape(it, end);
+                mCol = mCol + (stop - it);
+                it = stop;
+
+                if (it == end)
+                    break;
+
+                it = it + 1;
+                mCol = mCol + 1;
+
+                if (*stop == '\\')
+                {
+                    mEscape = true;
+                    mHasEscape = true;
+                    break;
+                }
+
+                if (mBuffer.empty())
+                    sendString(std::string_view(token, it - token));
+
+                else
+                {
+                    mBuffer.append(token, it - token);
+                    sendString(mBuffer);
+                    mBuffer.clear();
+                }
+
+                break;
+            }
+
+            case S_NUMBER:
+            {
+                while (it < end && isNumberCharacter(*it))
+                {
+                    it = it + 1;
+                    mCol = mCol + 1;
+                }
+
+                if (it == end)
+                    break;
+
+                if (mBuffer.empty())
+                    sendNumber(std::string_view(token, it - token));
+
+                else
+                {
+                    mBuffer.append(token, it - token);
+                    sendNumber(mBuffer);
+                    mBuffer.clear();
+                }
+
+                break;
+            }
+
+            case S_LITERAL:
+            {
+                JSON_THROW_IF(*it != mLiteral[mLiteralPos], JSON::Exception("Parser(%i:%i): unexpected character %c.",
+                mLine, mCol, *it));
+
+                it = it + 1;
+                mCol = mCol + 1;
+                mLiteralPos = mLiteralPos + 1;
+
+                if (mLiteral[mLiteralPos] == '\0')
+                {
+                    if (mLiteral[0] == 'n')
+                        mHandler.null();
+
+                    else
+                        mHandler.boolean(mLiteral[0] == 't');
+
+                    endValue();
+                }
+
+                break;
+            }
+        }
+    }
+
+    // Keeps the part of a token this chunk ends with.
+    if (mState == S_STRING || mState == S_NUMBER)
+        mBuffer.append(token, end - token);
+}
+
+void JSON::PushParser::finish()
+{
+    if (mState == S_NUMBER)
+    {
+        std::string token;
+        token.swap(mBuffer);
+        sendNumber(token);
+    }
+
+    JSON_THROW_IF(!mStack.empty() || (mState != S_AFTER && mState != S_VALUE),
+    JSON::Exception("Parser(%i:%i): unexpected EOF.", mLine, mCol));
+
+    mState = S_VALUE;
+    mLine = 0;
+    mCol = 0;
+}
+
+//! @brief The content of a file, mapped in memory when possible.
+//! Regular files are mapped and read sequentially by the parser. Inputs that cannot be
+//! mapped, like pipes, are read into a buffer: in one read when their size is known,
+//! by blocks of JSON_MAX_BUFFER bytes otherwise.
+class InputFile
+{
+    //! @brief The mapped content, or null if the content is buffered.
+    void* mMap = nullptr;
+
+    //! @brief The size of the mapped content.
+    std::size_t mSize = 0;
+
+    //! @brief The buffered content.
+    std::string mBuffer;
+
+public:
+    //! @brief Opens the file and maps or reads its content.
+    InputFile(const std::string& file);
+
+    //! @brief Unmaps the content.
+    ~InputFile();
+
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    //! @brief Returns the content of the file.
+    std::string_view content() const;
+};
+
+#if JSON_HAS_MMAP
+
+InputFile::InputFile(const std::string& file)
+{
+    int fd = ::open(file.data(), O_RDONLY);
+    JSON_THROW_IF(fd < 0, JSON::Exception("cannot open input file %s.", file.data()));
+
+    struct stat info;
+    std::size_t size = ::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) ? info.st_size : 0;
+
+    if (size)
+    {
+        void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (map != MAP_FAILED)
+        {
+            ::madvise(map, size, MADV_SEQUENTIAL);
+            mMap = map;
+            mSize = size;
+            ::close(fd);
+            return;
+        }
+    }
+
+    // Not mappable: the size is only a hint, some files like in /proc report none.
+    mBuffer.resize(size ? size : JSON_MAX_BUFFER);
+    std::size_t length = 0;
+
+    for (;;)
+    {
+        if (length == mBuffer.size())
+            mBuffer.resize(2 * mBuffer.size());
+
+        ssize_t count = ::read(fd, &mBuffer[length], mBuffer.size() - length);
+
+        if (count < 0 && errno == EINTR)
+            continue;
+
+        if (count <= 0)
+        {
+            ::close(fd);
+            JSON_THROW_IF(count < 0, JSON::Exception("cannot read input file %s.", file.data()));
+            break;
+        }
+
+        length = length + count;
+    }
+
+    mBuffer.resize(length);
+}
+
+InputFile::~InputFile()
+{
+    if (mMap)
+        ::munmap(mMap, mSize);
+}
+
+#else
+
+InputFile::InputFile(const std::string& file)
+{
+    std::ifstream stream(file.data(), std::ios::in | std::ios::binary);
+    JSON_THROW_IF(!stream, JSON::Exception("cannot open input file %s.", file.data()));
+
+    stream.seekg(0, std::ios::end);
+    std::streamoff size = stream.tellg();
+    stream.seekg(0, std::ios::beg);
+
+    if (size > 0)
+    {
+        mBuffer.resize(static_cast < std::size_t >(size));
+        stream.read(&mBuffer[0], size);
+        mBuffer.resize(static_cast < std::size_t >(stream.gcount()));
+    }
+
+    else
+    {
+        stream.clear();
+        mBuffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+}
+
+InputFile::~InputFile()
+{
+
+}
+
+#endif
+
+std::string_view InputFile::content() const
+{
+    if (mMap)
+        return std::string_view(static_cast < const char* >(mMap), mSize);
+
+    return mBuffer;
+}
+
 JSON JSON::load(const std::string& file)
 {
-	std::ifstream stream(file.data(), std::ios::in);
-	JSON_THROW_IF(!stream, Exception("cannot open input file %s.", file.data()));
-	
-	std::string content((std::istreambuf_iterator<char>(stream)),
-                 		 std::istreambuf_iterator<char>());
-	
-	stream.close();
-	
-	return loadContent(content);
-}
-
-JSON JSON::loadContent(const std::string &content)
-{
-    std::size_t currLine = 0, currCol = 0, currPos = 0;
-    currPos = findFirstCharacter(content, currPos, currLine, currCol);
-    JSON_THROW_IF(content[currPos] != '{', Exception("Parser(%i:%i): first character should be a '{'.",
-    currLine, currCol));
-    
-    return readObject(content, currPos, currLine, currCol);
+    InputFile input(file);
+    return loadContent(input.content());
+}
+
+JSON JSON::loadContent(std::string_view content, Storage storage)
+{
+    return Reader(content, nullptr, storage).readDocument();
+}
+
+const JSON& JSON::load(const std::string& file, Arena& arena)
+{
+    InputFile input(file);
+    return loadContent(input.content(), arena);
+}
+
+const JSON& JSON::loadContent(std::string_view content, Arena& arena)
+{
+    // The root is never destroyed: the arena releases it with everything else.
+    return *arena.make < JSON >(Reader(content, &arena, S_COPY).readDocument());
+}
+
+JSON::MappedDocument JSON::MappedDocument::open(const std::string& file)
+{
+    // The document shares the mapping with its copies, and unmaps it with the last of them.
+    auto input = std::make_shared < InputFile >(file);
+    MappedDocument document(input->content());
+    document.mOwner = std::move(input);
+    return document;
+}
+
+JSON::Array JSON::loadArray(const std::string& file, unsigned threads)
+{
+    InputFile input(file);
+    return loadArrayContent(input.content(), threads);
+}
+
+JSON::Array JSON::loadArrayContent(std::string_view content, unsigned threads)
+{
+    return Reader(content, nullptr, S_COPY).readArrayDocument(threads);
+}
+
+std::vector < JSON > JSON::loadLines(const std::string& file, unsigned threads)
+{
+    InputFile input(file);
+    return loadLinesContent(input.content(), threads);
+}
+
+void JSON::loadLines(const std::string& file, const RecordCallback& callback, unsigned threads)
+{
+    InputFile input(file);
+    loadLinesContent(input.content(), callback, threads);
+}
+
+void JSON::parse(std::string_view content, Handler& handler)
+{
+    Reader(content, nullptr, S_COPY).parseDocument(handler);
+}
+
+void JSON::parseFile(const std::string& file, Handler& handler)
+{
+    InputFile input(file);
+    parse(input.content(), handler);
 }
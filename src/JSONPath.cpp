@@ -0,0 +1,344 @@
+// JSONPath.cpp
+// The compiled queries of JSON documents.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+
+#include <algorithm>
+#include <cctype>
+
+JSON::Path::Step::Step()
+: hint(0)
+{
+
+}
+
+JSON::Path::Step::Step(const Step& rhs)
+: kind(rhs.kind)
+, hasBegin(rhs.hasBegin)
+, hasEnd(rhs.hasEnd)
+, key(rhs.key)
+, begin(rhs.begin)
+, end(rhs.end)
+, stride(rhs.stride)
+, hint(rhs.hint.load(std::memory_order_relaxed))
+{
+
+}
+
+JSON::Path::Step& JSON::Path::Step::operator=(const Step& rhs)
+{
+    kind = rhs.kind;
+    hasBegin = rhs.hasBegin;
+    hasEnd = rhs.hasEnd;
+    key = rhs.key;
+    begin = rhs.begin;
+    end = rhs.end;
+    stride = rhs.stride;
+    hint.store(rhs.hint.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+//! @brief Reads the integer at pos in the text, and moves pos past it. Returns false if
+//! there is none, or if it is out of range.
+static bool readInteger(std::string_view text, std::size_t& pos, std::int64_t& value)
+{
+    bool negative = pos < text.size() && text[pos] == '-';
+    std::size_t first = negative ? pos + 1 : pos, it = first;
+    std::uint64_t magnitude = 0;
+
+    for (; it < text.size() && std::isdigit(static_cast < unsigned char >(text[it])); ++it)
+    {
+        magnitude = magnitude * 10 + (text[it] - '0');
+
+        if (magnitude > static_cast < std::uint64_t >(INT64_MAX))
+            return false;
+    }
+
+    if (it == first)
+        return false;
+
+    value = negative ? -static_cast < std::int64_t >(magnitude) : static_cast < std::int64_t >(magnitude);
+    pos = it;
+    return true;
+}
+
+JSON::Path::Path(std::string_view expression)
+: mSingle(true)
+{
+    if (expression.empty() || expression[0] == '/')
+        parsePointer(expression);
+
+    else
+    {
+        JSON_THROW_IF(expression[0] != '$', Exception("Path(0): a path starts with '$' or '/'."));
+        parsePath(expression);
+    }
+
+    for (const Step& step : mSteps)
+        mSingle = mSingle && (step.kind == Step::S_MEMBER || step.kind == Step::S_INDEX);
+}
+
+void JSON::Path::parsePointer(std::string_view pointer)
+{
+    for (std::size_t pos = 0; pos < pointer.size();)
+    {
+        std::size_t end = std::min(pointer.find('/', pos + 1), pointer.size());
+        std::string_view token = pointer.substr(pos + 1, end - pos - 1);
+
+        mSteps.emplace_back();
+        Step& step = mSteps.back();
+
+        // "~1" stands for '/' and "~0" for '~'.
+        for (std::size_t i = 0; i < token.size(); ++i)
+        {
+            if (token[i] != '~')
+            {
+                step.key.push_back(token[i]);
+                continue;
+            }
+
+            JSON_THROW_IF(i + 1 == token.size() || (token[i + 1] != '0' && token[i + 1] != '1'),
+                          Exception("Path(%zu): invalid escape in a pointer.", pos + 1 + i));
+
+            step.key.push_back(token[i + 1] == '0' ? '~' : '/');
+            i = i + 1;
+        }
+
+        // Digits without a leading zero also index arrays.
+        std::size_t digits = 0;
+
+        if (!token.empty() && (token[0] != '0' || token.size() == 1))
+            step.hasBegin = readInteger(token, digits, step.begin) && digits == token.size() && token[0] != '-';
+
+        pos = end;
+    }
+}
+
+void JSON::Path::parsePath(std::string_view path)
+{
+    std::size_t pos = 1;
+
+    while (pos < path.size())
+    {
+        mSteps.emplace_back();
+        Step& step = mSteps.back();
+        std::size_t start = pos;
+
+        if (path[pos] == '.')
+        {
+            std::size_t end = std::min(path.find_first_of(".[", pos + 1), path.size());
+            step.key = path.substr(pos + 1, end - pos - 1);
+
+            JSON_THROW_IF(step.key.empty(), Exception("Path(%zu): empty key.", start));
+
+            if (step.key == "*")
+                step.kind = Step::S_WILDCARD;
+
+            pos = end;
+            continue;
+        }
+
+        JSON_THROW_IF(path[pos] != '[', Exception("Path(%zu): unexpected character %c.", pos, path[pos]));
+        pos = pos + 1;
+
+        if (pos < path.size() && (path[pos] == '\'' || path[pos] == '"'))
+        {
+            char quote = path[pos++];
+
+            for (; pos < path.size() && path[pos] != quote; ++pos)
+            {
+                if (path[pos] == '\\' && pos + 1 < path.size())
+                    pos = pos + 1;
+
+                step.key.push_back(path[pos]);
+            }
+
+            JSON_THROW_IF(pos == path.size(), Exception("Path(%zu): unterminated key.", start));
+            pos = pos + 1;
+        }
+
+        else if (pos < path.size() && path[pos] == '*')
+        {
+            step.kind = Step::S_WILDCARD;
+            pos = pos + 1;
+        }
+
+        else
+        {
+            step.kind = Step::S_INDEX;
+            step.hasBegin = readInteger(path, pos, step.begin);
+
+            if (pos < path.size() && path[pos] == ':')
+            {
+                step.kind = Step::S_SLICE;
+                pos = pos + 1;
+                step.hasEnd = readInteger(path, pos, step.end);
+
+                if (pos < path.size() && path[pos] == ':')
+                {
+                    pos = pos + 1;
+
+                    if (!readInteger(path, pos, step.stride))
+                        step.stride = 1;
+
+                    JSON_THROW_IF(step.stride <= 0, Exception("Path(%zu): the step of a slice must be positive.", start));
+                }
+            }
+
+            JSON_THROW_IF(step.kind == Step::S_INDEX && !step.hasBegin, Exception("Path(%zu): invalid index.", start));
+        }
+
+        JSON_THROW_IF(pos == path.size() || path[pos] != ']', Exception("Path(%zu): ']' expected.", pos));
+        pos = pos + 1;
+    }
+}
+
+const JSON::Value* JSON::Path::member(const JSON& object, const Step& step)
+{
+    // Documents of the same shape hold the member at the same position.
+    const Array& values = object.values();
+    std::uint32_t hint = step.hint.load(std::memory_order_relaxed);
+
+    if (hint < values.size() && values[hint].name() == step.key)
+        return &values[hint];
+
+    std::size_t position = object.find(step.key);
+
+    if (position == values.size())
+        return nullptr;
+
+    if (position <= UINT32_MAX)
+        step.hint.store(static_cast < std::uint32_t >(position), std::memory_order_relaxed);
+
+    return &values[position];
+}
+
+const JSON::Value* JSON::Path::select(const Value& value, const Step& step)
+{
+    if (value.isObject())
+        return step.kind == Step::S_MEMBER ? member(value.toObject(), step) : nullptr;
+
+    if (!value.isArray() || !step.hasBegin)
+        return nullptr;
+
+    const Array& array = value.toArray();
+    std::int64_t index = step.begin < 0 ? step.begin + static_cast < std::int64_t >(array.size()) : step.begin;
+
+    return index >= 0 && static_cast < std::uint64_t >(index) < array.size() ? &array[index] : nullptr;
+}
+
+void JSON::Path::collect(const JSON& object, std::size_t step, std::vector < const Value* >& results, std::size_t limit) const
+{
+    if (mSteps[step].kind == Step::S_MEMBER)
+    {
+        if (const Value* value = member(object, mSteps[step]))
+            collect(*value, step + 1, results, limit);
+    }
+
+    else if (mSteps[step].kind == Step::S_WILDCARD)
+    {
+        const Array& values = object.values();
+
+        for (std::size_t i = 0; i < values.size() && results.size() < limit; ++i)
+            collect(values[i], step + 1, results, limit);
+    }
+}
+
+void JSON::Path::collect(const Value& value, std::size_t step, std::vector < const Value* >& results, std::size_t limit) const
+{
+    if (step == mSteps.size())
+    {
+        results.push_back(&value);
+        return;
+    }
+
+    const Step& current = mSteps[step];
+
+    if (value.isObject())
+        collect(value.toObject(), step, results, limit);
+
+    else if (!value.isArray())
+        return;
+
+    else if (current.kind == Step::S_MEMBER || current.kind == Step::S_INDEX)
+    {
+        if (const Value* next = select(value, current))
+            collect(*next, step + 1, results, limit);
+    }
+
+    else
+    {
+        const Array& array = value.toArray();
+        std::int64_t size = static_cast < std::int64_t >(array.size());
+        std::int64_t begin = 0, end = size;
+
+        // Bounds are counted from the end when negative, and clamped like Python slices.
+        if (current.kind == Step::S_SLICE)
+        {
+            if (current.hasBegin)
+                begin = std::clamp < std::int64_t >(current.begin < 0 ? current.begin + size : current.begin, 0, size);
+
+            if (current.hasEnd)
+                end = std::clamp < std::int64_t >(current.end < 0 ? current.end + size : current.end, 0, size);
+        }
+
+        for (std::int64_t i = begin; i < end && results.size() < limit; i = end - i > current.stride ? i + current.stride : end)
+            collect(array[i], step + 1, results, limit);
+    }
+}
+
+const JSON::Value* JSON::Path::find(const JSON& document) const
+{
+    if (mSteps.empty())
+        return nullptr;
+
+    // Paths selecting a single value are walked without collecting.
+    if (mSingle)
+    {
+        const Value* value = mSteps[0].kind == Step::S_MEMBER ? member(document, mSteps[0]) : nullptr;
+
+        for (std::size_t i = 1; value && i < mSteps.size(); ++i)
+            value = select(*value, mSteps[i]);
+
+        return value;
+    }
+
+    std::vector < const Value* > results;
+    collect(document, 0, results, 1);
+    return results.empty() ? nullptr : results[0];
+}
+
+const JSON::Value* JSON::Path::find(const Value& value) const
+{
+    if (mSingle)
+    {
+        const Value* current = &value;
+
+        for (std::size_t i = 0; current && i < mSteps.size(); ++i)
+            current = select(*current, mSteps[i]);
+
+        return current;
+    }
+
+    std::vector < const Value* > results;
+    collect(value, 0, results, 1);
+    return results.empty() ? nullptr : results[0];
+}
+
+std::vector < const JSON::Value* > JSON::Path::findAll(const JSON& document) const
+{
+    std::vector < const Value* > results;
+
+    if (!mSteps.empty())
+        collect(document, 0, results, std::numeric_limits < std::size_t >::max());
+
+    return results;
+}
+
+std::vector < const JSON::Value* > JSON::Path::findAll(const Value& value) const
+{
+    std::vector < const Value* > results;
+    collect(value, 0, results, std::numeric_limits < std::size_t >::max());
+    return results;
+}
@@ -0,0 +1,99 @@
+// JSONPool.h
+// The thread pool of the parallel loaders.
+// Copyright 2019 @Atlanti's Corp
+
+// Included by the parallel loaders.
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! @brief Runs a fixed number of tasks on a pool of threads.
+//! Each thread is given an even share of the tasks, which it takes from the front. Once
+//! its share is done, it steals tasks from the back of the other shares, so that threads
+//! given slower tasks are helped instead of waited for.
+class WorkStealingPool
+{
+    //! @brief The tasks left in the share of a thread, from begin to end.
+    struct Share
+    {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    //! @brief The shares, one per thread.
+    std::vector < Share > mShares;
+
+    //! @brief Takes the next task of the share, from its front for its owner or from its back
+    //! for a thief.
+    //! @return false if the share is empty.
+    static bool take(Share& share, bool owner, std::size_t& task)
+    {
+        std::lock_guard < std::mutex > lock(share.mutex);
+
+        if (share.begin == share.end)
+            return false;
+
+        if (owner)
+        {
+            task = share.begin;
+            share.begin = share.begin + 1;
+        }
+
+        else
+        {
+            share.end = share.end - 1;
+            task = share.end;
+        }
+
+        return true;
+    }
+
+    //! @brief Runs the tasks of the share of a thread, then the ones it steals.
+    template < typename Task >
+    void work(std::size_t thread, const Task& execute)
+    {
+        std::size_t task;
+
+        while (take(mShares[thread], true, task))
+            execute(task);
+
+        for (std::size_t i = 1; i < mShares.size(); ++i)
+        {
+            Share& victim = mShares[(thread + i) % mShares.size()];
+
+            while (take(victim, false, task))
+                execute(task);
+        }
+    }
+
+public:
+    //! @brief Splits count tasks between threads shares.
+    WorkStealingPool(std::size_t count, unsigned threads)
+    : mShares(threads)
+    {
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            mShares[i].begin = count * i / threads;
+            mShares[i].end = count * (i + 1) / threads;
+        }
+    }
+
+    //! @brief Runs every task, the calling thread being one of the threads, and returns
+    //! once they are all done. execute must not throw.
+    template < typename Task >
+    void run(const Task& execute)
+    {
+        std::vector < std::thread > threads;
+        threads.reserve(mShares.size() - 1);
+
+        for (std::size_t i = 1; i < mShares.size(); ++i)
+            threads.emplace_back([this, i, &execute]() { work(i, execute); });
+
+        work(0, execute);
+
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+};
@@ -0,0 +1,108 @@
+// JSONReader.h
+// The reader of the JSON Parser.
+// Copyright 2019 @Atlanti's Corp
+
+// Included after JSONPP.h by the parser sources.
+
+//! @brief Reads a texted JSON.
+//! The Reader walks the content once, keeping the current line and column for error
+//! messages. Keys and strings are sliced out of the content and only decoded when
+//! they hold escapes; depending on the storage they are then viewed or copied.
+class JSON::Reader
+{
+    //! @brief The content being read.
+    std::string_view mContent;
+
+    //! @brief The current position in the content.
+    std::size_t mPos;
+
+    //! @brief The current line, for error messages.
+    std::size_t mLine;
+
+    //! @brief The current column, for error messages.
+    std::size_t mCol;
+
+    //! @brief The arena to allocate the document from, or null for the heap.
+    Arena* mArena;
+
+    //! @brief How keys and strings are stored.
+    Storage mStorage;
+
+    //! @brief Holds the last string decoded by parseString().
+    std::string mScratch;
+
+    friend class PushParser;
+    friend class LazyValue;
+    friend class Cursor;
+
+public:
+    //! @brief Constructs a Reader for the content.
+    Reader(std::string_view content, Arena* arena, Storage storage);
+
+    //! @brief Reads the top-level object.
+    JSON readDocument();
+
+    //! @brief Reads the top-level object of a record, which only whitespaces may follow.
+    //! @param line The line of the record in its file, for error messages.
+    JSON readRecord(std::size_t line);
+
+    //! @brief Reads the top-level array, which only whitespaces may follow.
+    //! @param threads The number of threads to split a large array between, 0 for one per core.
+    JSON::Array readArrayDocument(unsigned threads);
+
+    //! @brief Reads the top-level value and sends its events to the handler.
+    void parseDocument(Handler& handler);
+
+private:
+    //! @brief Returns the current character, or zero past the end of the content.
+    char current() const;
+
+    //! @brief Skips whitespaces from the current position.
+    void findFirstCharacter();
+    //! @brief Skips the current character and the whitespaces after it.
+    void findNextCharacter();
+    //! @brief Checks that only whitespaces follow the current character.
+    void checkEnd();
+
+    //! @brief Reads the string at the current position and leaves it on its closing quote.
+    //! @param escaped Set to true if the string held escapes, in which case the view
+    //! points to mScratch and is only valid until the next call.
+    //! @return The string, viewing the content if it had no escapes.
+    std::string_view parseString(bool& escaped);
+    //! @brief Decodes the escape sequence at the current position into mScratch.
+    void parseEscape();
+
+    JSON::Array readArray();
+    //! @brief Reads the elements following the current '[' or ',' into array, up to the first
+    //! ',' at or after the stop offset or the closing ']', and leaves the position on it.
+    void readElements(JSON::Array& array, std::size_t stop);
+    //! @brief Reads the elements of the array at the current '[' into array on a pool of threads,
+    //! see JSONArrays.cpp, and leaves the position on its closing ']'.
+    void readElementsInParallel(JSON::Array& array, unsigned threads);
+    //! @brief Guesses the offset of a ',' between two elements of an array, from offset to limit.
+    //! Raw newlines are never inside strings, so the search starts after a newline, or else after
+    //! the ':' of a key if there is one, and keeps the first ',' at the lowest depth met, between the end of an
+    //! element like the first one and the start of another. Only the first JSON_ARRAY_PIECE / 16
+    //! bytes are searched.
+    //! @param opening The first character of the first element.
+    //! @return The offset of the ',', or npos if there is none.
+    static std::size_t guessSplit(std::string_view content, std::size_t offset, std::size_t limit, char opening);
+    //! @brief Moves forward to the offset, counting the lines skipped for error messages.
+    void seek(std::size_t offset);
+    //! @brief Reads the number at the current position into value.
+    void readNumber(JSON::Value& value);
+    bool readBoolean();
+    //! @brief Checks the null literal at the current position and leaves it on its last character.
+    void readNull();
+    //! @brief Reads the key of a member and its ':', and leaves the position on its value.
+    std::string_view readKey(bool& escaped);
+    JSON::Value readValueContent(std::string_view name, bool escaped);
+    JSON::Value readValue();
+    JSON readObject();
+
+    void parseValue(Handler& handler);
+    //! @brief Sends the number read by readNumber() to the handler.
+    static void sendNumber(const Value& number, Handler& handler);
+    void parseArray(Handler& handler);
+    void parseObject(Handler& handler);
+};
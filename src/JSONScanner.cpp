@@ -0,0 +1,294 @@
+// JSONScanner.cpp
+// The scanning kernels of the JSON Parser.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+#include "JSONScanner.h"
+
+#include <atomic>
+
+#if JSON_SIMD && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   include <immintrin.h>
+#   define JSON_SCANNER_X86 1
+#endif
+
+//! @brief Returns true for the four JSON whitespaces.
+static inline bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static const char* skipWhitespaceScalar(const char* begin, const char* end, std::size_t& count, const char*& last)
+{
+    while (begin < end && isWhitespace(*begin))
+    {
+        if (*begin == '\n')
+        {
+            count = count + 1;
+            last = begin;
+        }
+
+        begin = begin + 1;
+    }
+
+    return begin;
+}
+
+static const char* findQuoteOrEscapeScalar(const char* begin, const char* end)
+{
+    while (begin < end && *begin != '"' && *begin != '\\')
+        begin = begin + 1;
+
+    return begin;
+}
+
+//! @brief Returns true for the characters the structure of a document is made of.
+static inline bool isStructural(char c)
+{
+    return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',' || c == '"';
+}
+
+static const char* findStructuralScalar(const char* begin, const char* end)
+{
+    while (begin < end && !isStructural(*begin))
+        begin = begin + 1;
+
+    return begin;
+}
+
+#if JSON_SCANNER_X86
+
+//! @brief Counts the newlines flagged in mask, a block of bits for the bytes from block.
+static inline void countLines(unsigned mask, const char* block, std::size_t& count, const char*& last)
+{
+    if (mask)
+    {
+        count = count + __builtin_popcount(mask);
+        last = block + 31 - __builtin_clz(mask);
+    }
+}
+
+__attribute__((target("sse2")))
+static const char* skipWhitespaceSSE2(const char* begin, const char* end, std::size_t& count, const char*& last)
+{
+    const __m128i space = _mm_set1_epi8(' '), newline = _mm_set1_epi8('\n');
+    const __m128i carriage = _mm_set1_epi8('\r'), tab = _mm_set1_epi8('\t');
+
+    while (end - begin >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast < const __m128i* >(begin));
+        __m128i lf = _mm_cmpeq_epi8(chunk, newline);
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), lf),
+                                  _mm_or_si128(_mm_cmpeq_epi8(chunk, carriage), _mm_cmpeq_epi8(chunk, tab)));
+
+        unsigned wsMask = static_cast < unsigned >(_mm_movemask_epi8(ws));
+        unsigned lfMask = static_cast < unsigned >(_mm_movemask_epi8(lf));
+
+        if (wsMask != 0xFFFF)
+        {
+            unsigned stop = __builtin_ctz(~wsMask);
+            countLines(lfMask & ((1u << stop) - 1), begin, count, last);
+            return begin + stop;
+        }
+
+        countLines(lfMask, begin, count, last);
+        begin = begin + 16;
+    }
+
+    return skipWhitespaceScalar(begin, end, count, last);
+}
+
+__attribute__((target("sse2")))
+static const char* findQuoteOrEscapeSSE2(const char* begin, const char* end)
+{
+    const __m128i quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\');
+
+    while (end - begin >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast < const __m128i* >(begin));
+        unsigned mask = static_cast < unsigned >(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                                                _mm_cmpeq_epi8(chunk, backslash))));
+
+        if (mask)
+            return begin + __builtin_ctz(mask);
+
+        begin = begin + 16;
+    }
+
+    return findQuoteOrEscapeScalar(begin, end);
+}
+
+__attribute__((target("sse2")))
+static const char* findStructuralSSE2(const char* begin, const char* end)
+{
+    const __m128i openCurly = _mm_set1_epi8('{'), closeCurly = _mm_set1_epi8('}');
+    const __m128i openSquare = _mm_set1_epi8('['), closeSquare = _mm_set1_epi8(']');
+    const __m128i colon = _mm_set1_epi8(':'), comma = _mm_set1_epi8(','), quote = _mm_set1_epi8('"');
+
+    while (end - begin >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast < const __m128i* >(begin));
+        __m128i brackets = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, openCurly), _mm_cmpeq_epi8(chunk, closeCurly)),
+                                        _mm_or_si128(_mm_cmpeq_epi8(chunk, openSquare), _mm_cmpeq_epi8(chunk, closeSquare)));
+        __m128i separators = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma)),
+                                          _mm_cmpeq_epi8(chunk, quote));
+        __m128i found = _mm_or_si128(brackets, separators);
+
+        unsigned mask = static_cast < unsigned >(_mm_movemask_epi8(found));
+
+        if (mask)
+            return begin + __builtin_ctz(mask);
+
+        begin = begin + 16;
+    }
+
+    return findStructuralScalar(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char* skipWhitespaceAVX2(const char* begin, const char* end, std::size_t& count, const char*& last)
+{
+    const __m256i space = _mm256_set1_epi8(' '), newline = _mm256_set1_epi8('\n');
+    const __m256i carriage = _mm256_set1_epi8('\r'), tab = _mm256_set1_epi8('\t');
+
+    while (end - begin >= 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast < const __m256i* >(begin));
+        __m256i lf = _mm256_cmpeq_epi8(chunk, newline);
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), lf),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(chunk, carriage),
+                                                     _mm256_cmpeq_epi8(chunk, tab)));
+
+        unsigned wsMask = static_cast < unsigned >(_mm256_movemask_epi8(ws));
+        unsigned lfMask = static_cast < unsigned >(_mm256_movemask_epi8(lf));
+
+        if (wsMask != 0xFFFFFFFFu)
+        {
+            unsigned stop = __builtin_ctz(~wsMask);
+            countLines(lfMask & ((1u << stop) - 1), begin, count, last);
+            return begin + stop;
+        }
+
+        countLines(lfMask, begin, count, last);
+        begin = begin + 32;
+    }
+
+    return skipWhitespaceSSE2(begin, end, count, last);
+}
+
+__attribute__((target("avx2")))
+static const char* findQuoteOrEscapeAVX2(const char* begin, const char* end)
+{
+    const __m256i quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\');
+
+    while (end - begin >= 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast < const __m256i* >(begin));
+        unsigned mask = static_cast < unsigned >(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                                                                      _mm256_cmpeq_epi8(chunk, backslash))));
+
+        if (mask)
+            return begin + __builtin_ctz(mask);
+
+        begin = begin + 32;
+    }
+
+    return findQuoteOrEscapeSSE2(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char* findStructuralAVX2(const char* begin, const char* end)
+{
+    const __m256i openCurly = _mm256_set1_epi8('{'), closeCurly = _mm256_set1_epi8('}');
+    const __m256i openSquare = _mm256_set1_epi8('['), closeSquare = _mm256_set1_epi8(']');
+    const __m256i colon = _mm256_set1_epi8(':'), comma = _mm256_set1_epi8(','), quote = _mm256_set1_epi8('"');
+
+    while (end - begin >= 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast < const __m256i* >(begin));
+        __m256i brackets = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, openCurly),
+                                                           _mm256_cmpeq_epi8(chunk, closeCurly)),
+                                           _mm256_or_si256(_mm256_cmpeq_epi8(chunk, openSquare),
+                                                           _mm256_cmpeq_epi8(chunk, closeSquare)));
+        __m256i separators = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon),
+                                                             _mm256_cmpeq_epi8(chunk, comma)),
+                                             _mm256_cmpeq_epi8(chunk, quote));
+        __m256i found = _mm256_or_si256(brackets, separators);
+
+        unsigned mask = static_cast < unsigned >(_mm256_movemask_epi8(found));
+
+        if (mask)
+            return begin + __builtin_ctz(mask);
+
+        begin = begin + 32;
+    }
+
+    return findStructuralSSE2(begin, end);
+}
+
+#endif
+
+//! @brief The kernels selected for this CPU.
+struct Kernels
+{
+    const char* name;
+    const char* (*skipWhitespace)(const char*, const char*, std::size_t&, const char*&);
+    const char* (*findQuoteOrEscape)(const char*, const char*);
+    const char* (*findStructural)(const char*, const char*);
+};
+
+static const Kernels gScalarKernels = { "scalar", skipWhitespaceScalar, findQuoteOrEscapeScalar,
+                                          findStructuralScalar };
+
+#if JSON_SCANNER_X86
+static const Kernels gSSE2Kernels = { "sse2", skipWhitespaceSSE2, findQuoteOrEscapeSSE2, findStructuralSSE2 };
+static const Kernels gAVX2Kernels = { "avx2", skipWhitespaceAVX2, findQuoteOrEscapeAVX2, findStructuralAVX2 };
+#endif
+
+//! @brief The selected kernels, or null until the first call.
+//! Constant-initialized, so documents may be loaded from other static initializers.
+static std::atomic < const Kernels* > gKernels(nullptr);
+
+static const Kernels& kernels()
+{
+    const Kernels* selected = gKernels.load(std::memory_order_relaxed);
+
+    if (!selected)
+    {
+        selected = &gScalarKernels;
+
+#if JSON_SCANNER_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+            selected = &gAVX2Kernels;
+
+        else if (__builtin_cpu_supports("sse2"))
+            selected = &gSSE2Kernels;
+#endif
+
+        gKernels.store(selected, std::memory_order_relaxed);
+    }
+
+    return *selected;
+}
+
+const char* JSON::Scanner::skipWhitespace(const char* begin, const char* end, Lines& lines)
+{
+    return kernels().skipWhitespace(begin, end, lines.count, lines.last);
+}
+
+const char* JSON::Scanner::findQuoteOrEscape(const char* begin, const char* end)
+{
+    return kernels().findQuoteOrEscape(begin, end);
+}
+
+const char* JSON::Scanner::findStructural(const char* begin, const char* end)
+{
+    return kernels().findStructural(begin, end);
+}
+
+const char* JSON::Scanner::kernel()
+{
+    return kernels().name;
+}
@@ -0,0 +1,36 @@
+// JSONScanner.h
+// The scanning kernels of the JSON Parser.
+// Copyright 2019 @Atlanti's Corp
+
+// Included after JSONPP.h by the parser sources.
+
+//! @brief Finds the bytes the parser stops on.
+//! Each function is implemented with AVX2, SSE2 and portable kernels. The kernel is
+//! chosen on the first call from the instructions the CPU supports, and the portable
+//! one is used when the library is built with JSON_SIMD set to 0 or for another CPU.
+class JSON::Scanner
+{
+public:
+    //! @brief Counts the newlines a scan went over.
+    struct Lines
+    {
+        //! @brief The number of newlines.
+        std::size_t count = 0;
+
+        //! @brief The last newline, or null if there is none.
+        const char* last = nullptr;
+    };
+
+    //! @brief Returns the first byte that is not a JSON whitespace, or end.
+    //! @param lines Incremented with the newlines skipped.
+    static const char* skipWhitespace(const char* begin, const char* end, Lines& lines);
+
+    //! @brief Returns the first '"' or '\\', or end.
+    static const char* findQuoteOrEscape(const char* begin, const char* end);
+
+    //! @brief Returns the first of '{', '}', '[', ']', ':', ',' or '"', or end.
+    static const char* findStructural(const char* begin, const char* end);
+
+    //! @brief Returns the name of the kernels in use: "avx2", "sse2" or "scalar".
+    static const char* kernel();
+};
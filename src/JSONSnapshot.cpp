@@ -0,0 +1,98 @@
+// JSONSnapshot.cpp
+// The documents shared by the threads reading them.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+
+#include <thread>
+
+JSON::Snapshot::Snapshot()
+{
+    // Every empty snapshot shares the same document.
+    static const std::shared_ptr < const JSON > empty = std::make_shared < const JSON >();
+    mDocument = empty;
+}
+
+JSON::Snapshot::Snapshot(JSON document)
+: mDocument(std::make_shared < const JSON >(std::move(document)))
+{
+
+}
+
+const JSON& JSON::Snapshot::operator*() const noexcept
+{
+    return *mDocument;
+}
+
+const JSON* JSON::Snapshot::operator->() const noexcept
+{
+    return mDocument.get();
+}
+
+const JSON::Value& JSON::Snapshot::operator[](std::string_view name) const
+{
+    return mDocument->value(name);
+}
+
+JSON::AtomicDocument::AtomicDocument()
+: AtomicDocument(Snapshot())
+{
+
+}
+
+JSON::AtomicDocument::AtomicDocument(Snapshot snapshot)
+: mSlots()
+, mCurrent(new Snapshot(std::move(snapshot)))
+, mEpoch(0)
+{
+
+}
+
+JSON::AtomicDocument::~AtomicDocument()
+{
+    delete mCurrent.load(std::memory_order_acquire);
+}
+
+JSON::Snapshot JSON::AtomicDocument::load() const
+{
+    thread_local const std::size_t slot = std::hash < std::thread::id >()(std::this_thread::get_id()) % JSON_SNAPSHOT_SLOTS;
+
+    // A writer missing this count replaced the snapshot before it was made: the one read
+    // below is then the new one.
+    std::atomic < std::uint32_t >& readers = mSlots[slot].readers[mEpoch.load() & 1];
+    readers.fetch_add(1);
+
+    Snapshot snapshot(*mCurrent.load());
+
+    readers.fetch_sub(1, std::memory_order_release);
+    return snapshot;
+}
+
+void JSON::AtomicDocument::store(Snapshot snapshot)
+{
+    exchange(std::move(snapshot));
+}
+
+JSON::Snapshot JSON::AtomicDocument::exchange(Snapshot snapshot)
+{
+    std::unique_ptr < const Snapshot > replacement(new Snapshot(std::move(snapshot)));
+    std::lock_guard < std::mutex > lock(mStoring);
+
+    std::unique_ptr < const Snapshot > previous(mCurrent.exchange(replacement.release()));
+
+    // Readers may have read the epoch long ago and count themselves in either parity. Each
+    // parity is waited for while new readers count themselves in the other, so the readers
+    // waited for only get fewer.
+    for (int phase = 0; phase < 2; ++phase)
+    {
+        std::uint32_t parity = mEpoch.fetch_add(1) & 1;
+
+        for (Slot& slot : mSlots)
+        {
+            while (slot.readers[parity].load(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+    }
+
+    return *previous;
+}
@@ -0,0 +1,224 @@
+// JSONWatcher.cpp
+// The documents parsed again when their file changes.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+
+#if defined(__linux__)
+#define JSON_HAS_INOTIFY 1
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#define JSON_HAS_INOTIFY 0
+#endif
+
+JSON::Watcher::Watcher(const std::string& file, Callback callback, std::chrono::milliseconds debounce)
+: mFile(file)
+, mCallback(std::move(callback))
+, mDebounce(debounce)
+, mIdentity(identity())
+, mDocument(Snapshot(JSON::load(file)))
+, mEvents(0)
+, mReloads(0)
+, mFailures(0)
+, mStopping(false)
+, mNotify(-1)
+, mPipe{ -1, -1 }
+{
+#if JSON_HAS_INOTIFY
+    // The directory is watched rather than the file: files are often replaced by renaming
+    // another one over them.
+    std::filesystem::path path(mFile);
+    std::string directory = path.has_parent_path() ? path.parent_path().string() : std::string(".");
+
+    mNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (mNotify < 0 || inotify_add_watch(mNotify, directory.c_str(), IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+                                         IN_MOVED_TO | IN_CREATE | IN_DELETE) < 0 || pipe2(mPipe, O_CLOEXEC) < 0)
+    {
+        int error = errno;
+
+        if (mNotify >= 0)
+            close(mNotify);
+
+        JSON_THROW(Exception("Watcher: cannot watch %s: %s.", mFile.c_str(), std::strerror(error)));
+    }
+#endif
+
+    mThread = std::thread(&Watcher::run, this);
+}
+
+JSON::Watcher::~Watcher()
+{
+    {
+        std::lock_guard < std::mutex > lock(mMutex);
+        mStopping = true;
+    }
+
+    mWakeUp.notify_all();
+
+#if JSON_HAS_INOTIFY
+    char byte = 0;
+
+    while (write(mPipe[1], &byte, 1) < 0 && errno == EINTR)
+        continue;
+#endif
+
+    mThread.join();
+
+#if JSON_HAS_INOTIFY
+    close(mNotify);
+    close(mPipe[0]);
+    close(mPipe[1]);
+#endif
+}
+
+std::pair < std::int64_t, std::uintmax_t > JSON::Watcher::identity() const
+{
+    std::error_code timeError, sizeError;
+    auto time = std::filesystem::last_write_time(mFile, timeError);
+    std::uintmax_t size = std::filesystem::file_size(mFile, sizeError);
+
+    // A missing file is a change too: it fails to parse, once.
+    if (timeError || sizeError)
+        return std::make_pair(INT64_MIN, 0);
+
+    return std::make_pair(static_cast < std::int64_t >(time.time_since_epoch().count()), size);
+}
+
+void JSON::Watcher::run()
+{
+#if JSON_HAS_INOTIFY
+    std::string name = std::filesystem::path(mFile).filename().string();
+    alignas(inotify_event) char buffer[4096];
+    bool pending = false;
+
+    for (;;)
+    {
+        pollfd fds[2] = { { mNotify, POLLIN, 0 }, { mPipe[0], POLLIN, 0 } };
+
+        // Once a change came, the file is parsed when no other came for the debounce delay.
+        int ready = poll(fds, 2, pending ? static_cast < int >(mDebounce.count()) : -1);
+
+        if (ready < 0 && errno == EINTR)
+            continue;
+
+        if (ready < 0 || fds[1].revents)
+            return;
+
+        if (ready == 0)
+        {
+            pending = false;
+            reload();
+            continue;
+        }
+
+        ssize_t size;
+
+        while ((size = read(mNotify, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* it = buffer; it < buffer + size;)
+            {
+                const inotify_event* event = reinterpret_cast < const inotify_event* >(it);
+
+                if ((event->mask & IN_Q_OVERFLOW) || (event->len && name == event->name))
+                {
+                    mEvents.fetch_add(1, std::memory_order_relaxed);
+                    pending = true;
+                }
+
+                it += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+#else
+    // Without notifications, the file is checked at each debounce delay, and parsed once it
+    // stayed the same for a whole delay.
+    std::pair < std::int64_t, std::uintmax_t > seen = mIdentity;
+    std::unique_lock < std::mutex > lock(mMutex);
+
+    while (!mWakeUp.wait_for(lock, mDebounce, [this] { return mStopping; }))
+    {
+        lock.unlock();
+        std::pair < std::int64_t, std::uintmax_t > current = identity();
+
+        if (current != seen)
+        {
+            seen = current;
+            mEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        else
+            reload();
+
+        lock.lock();
+    }
+#endif
+}
+
+void JSON::Watcher::reload()
+{
+    std::pair < std::int64_t, std::uintmax_t > current = identity();
+
+    if (current == mIdentity)
+        return;
+
+    mIdentity = current;
+    std::optional < Snapshot > snapshot;
+
+    try
+    {
+        snapshot.emplace(JSON::load(mFile));
+    }
+
+    catch(const std::exception& exception)
+    {
+        mFailures.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard < std::mutex > lock(mMutex);
+        mError = exception.what();
+        return;
+    }
+
+    mDocument.store(*snapshot);
+    mReloads.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        std::lock_guard < std::mutex > lock(mMutex);
+        mError.clear();
+    }
+
+    if (mCallback)
+        mCallback(*snapshot);
+}
+
+JSON::Snapshot JSON::Watcher::load() const
+{
+    return mDocument.load();
+}
+
+const JSON::AtomicDocument& JSON::Watcher::document() const noexcept
+{
+    return mDocument;
+}
+
+JSON::Watcher::Stats JSON::Watcher::stats() const noexcept
+{
+    Stats stats;
+    stats.events = mEvents.load(std::memory_order_relaxed);
+    stats.reloads = mReloads.load(std::memory_order_relaxed);
+    stats.failures = mFailures.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::string JSON::Watcher::error() const
+{
+    std::lock_guard < std::mutex > lock(mMutex);
+    return mError;
+}
@@ -0,0 +1,303 @@
+// JSONWriter.cpp
+// The writer of texted JSON.
+// Copyright 2019 @Atlanti's Corp
+
+#include "JSONPP.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <ostream>
+
+#if defined(_WIN32)
+#   include <io.h>
+#   define JSON_WRITE_FD(FD, DATA, SIZE) ::_write(FD, DATA, static_cast < unsigned >(SIZE))
+#else
+#   include <cerrno>
+#   include <unistd.h>
+#   define JSON_WRITE_FD(FD, DATA, SIZE) ::write(FD, DATA, SIZE)
+#endif
+
+JSON::Writer::Writer(Layout layout, std::string_view indent, unsigned level)
+: mStream(nullptr)
+, mFd(-1)
+, mLayout(layout)
+, mIndent(indent)
+, mLevel(level)
+{
+
+}
+
+JSON::Writer::Writer(std::ostream& stream, Layout layout, std::string_view indent)
+: Writer(layout, indent)
+{
+    mStream = &stream;
+}
+
+JSON::Writer::Writer(int fd, Layout layout, std::string_view indent)
+: Writer(layout, indent)
+{
+    mFd = fd;
+}
+
+JSON::Writer::~Writer()
+{
+    // Destructors must not throw: a failed write is lost.
+    try
+    {
+        flush();
+    }
+
+    catch(const Exception&)
+    {
+
+    }
+}
+
+void JSON::Writer::newLine()
+{
+    if (mLayout == L_PRETTY)
+    {
+        mBuffer.push_back('\n');
+
+        for (unsigned i = 0; i < mLevel; ++i)
+            mBuffer.append(mIndent);
+    }
+}
+
+void JSON::Writer::open(char bracket)
+{
+    mBuffer.push_back(bracket);
+    mLevel = mLevel + 1;
+}
+
+void JSON::Writer::next(bool first)
+{
+    if (!first)
+        mBuffer.push_back(',');
+
+    newLine();
+}
+
+void JSON::Writer::close(char bracket, std::size_t count)
+{
+    mLevel = mLevel - 1;
+
+    // Empty objects and arrays stay on one line.
+    if (count)
+        newLine();
+
+    mBuffer.push_back(bracket);
+}
+
+void JSON::Writer::writeName(std::string_view name)
+{
+    writeString(name);
+    mBuffer.append(mLayout == L_PRETTY ? ": " : ":");
+}
+
+void JSON::Writer::writeInteger(std::int64_t number)
+{
+    char buffer[24];
+    mBuffer.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), number).ptr - buffer);
+}
+
+void JSON::Writer::writeUnsigned(std::uint64_t number)
+{
+    char buffer[24];
+    mBuffer.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), number).ptr - buffer);
+}
+
+void JSON::Writer::writeNumber(double number)
+{
+    char buffer[32];
+    char* end = buffer;
+
+    // JSON has no infinities or NaN.
+    if (!std::isfinite(number))
+        end = std::copy_n("null", 4, buffer);
+
+    // "-0" would parse back as the integer 0.
+    else if (number == 0 && std::signbit(number))
+        end = std::copy_n("-0.0", 4, buffer);
+
+    // Integral numbers are written without fraction or exponent while they are exact.
+    else if (number == std::trunc(number) && std::fabs(number) < 0x1p53)
+        end = std::to_chars(buffer, buffer + sizeof(buffer), static_cast < std::int64_t >(number)).ptr;
+
+    // The shortest text parsing back to the same double, whatever the locale.
+    else
+        end = std::to_chars(buffer, buffer + sizeof(buffer), number).ptr;
+
+    mBuffer.append(buffer, end - buffer);
+}
+
+void JSON::Writer::spill()
+{
+    if ((mStream || mFd >= 0) && mBuffer.size() >= JSON_WRITER_BLOCK)
+        flush();
+}
+
+void JSON::Writer::writeString(std::string_view string)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    mBuffer.push_back('"');
+
+    // Appends runs of characters which need no escape at once.
+    std::size_t run = 0;
+
+    for (std::size_t i = 0; i < string.size(); ++i)
+    {
+        unsigned char c = static_cast < unsigned char >(string[i]);
+
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        mBuffer.append(string.data() + run, i - run);
+        run = i + 1;
+
+        switch (c)
+        {
+            case '"': mBuffer.append("\\\""); break;
+            case '\\': mBuffer.append("\\\\"); break;
+            case '\b': mBuffer.append("\\b"); break;
+            case '\f': mBuffer.append("\\f"); break;
+            case '\n': mBuffer.append("\\n"); break;
+            case '\r': mBuffer.append("\\r"); break;
+            case '\t': mBuffer.append("\\t"); break;
+
+            default:
+                mBuffer.append("\\u00");
+                mBuffer.push_back(hex[c >> 4]);
+                mBuffer.push_back(hex[c & 0xF]);
+        }
+    }
+
+    mBuffer.append(string.data() + run, string.size() - run);
+    mBuffer.push_back('"');
+}
+
+void JSON::Writer::writePayload(const Value& value)
+{
+    switch (value.mType)
+    {
+        case Value::T_OBJECT:
+            writeObject(*value.mObject);
+            break;
+
+        case Value::T_ARRAY:
+            writeArray(*value.mArray);
+            break;
+
+        case Value::T_STRING:
+            writeString(value.toStringView());
+            break;
+
+        case Value::T_NUMBER:
+            if (value.mFlags & Value::F_INTEGER)
+                writeInteger(value.mInteger);
+
+            else if (value.mFlags & Value::F_UNSIGNED)
+                writeUnsigned(value.mUnsigned);
+
+            else
+                writeNumber(value.mNumber);
+
+            break;
+
+        case Value::T_BOOLEAN:
+            mBuffer.append(value.mBoolean ? "true" : "false");
+            break;
+
+        case Value::T_NULL:
+            mBuffer.append("null");
+            break;
+    }
+
+    spill();
+}
+
+void JSON::Writer::writeObject(const JSON& object)
+{
+    const Array& values = object.values();
+    open('{');
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        // Members are always written with their key, even an empty one.
+        next(i == 0);
+        writeName(values[i].name());
+        writePayload(values[i]);
+    }
+
+    close('}', values.size());
+}
+
+void JSON::Writer::writeArray(const Array& array)
+{
+    open('[');
+
+    for (std::size_t i = 0; i < array.size(); ++i)
+    {
+        next(i == 0);
+        writePayload(array[i]);
+    }
+
+    close(']', array.size());
+}
+
+JSON::Writer& JSON::Writer::write(const JSON& object)
+{
+    writeObject(object);
+    spill();
+    return *this;
+}
+
+JSON::Writer& JSON::Writer::write(const Value& value)
+{
+    if (!value.name().empty())
+        writeName(value.name());
+
+    writePayload(value);
+    return *this;
+}
+
+std::string_view JSON::Writer::content() const
+{
+    return mBuffer;
+}
+
+void JSON::Writer::clear()
+{
+    mBuffer.clear();
+}
+
+void JSON::Writer::flush()
+{
+    if (mStream)
+    {
+        mStream->write(mBuffer.data(), static_cast < std::streamsize >(mBuffer.size()));
+        mBuffer.clear();
+    }
+
+    else if (mFd >= 0)
+    {
+        std::size_t written = 0;
+
+        while (written < mBuffer.size())
+        {
+            auto count = JSON_WRITE_FD(mFd, mBuffer.data() + written, mBuffer.size() - written);
+
+#if !defined(_WIN32)
+            if (count < 0 && errno == EINTR)
+                continue;
+#endif
+
+            JSON_THROW_IF(count <= 0, Exception("Writer: cannot write to file descriptor %i.", mFd));
+            written = written + static_cast < std::size_t >(count);
+        }
+
+        mBuffer.clear();
+    }
+}